@@ -17,6 +17,190 @@
 #define WIDTH  400
 #define HEIGHT 400
 
+/* 
+  CONSTANTS 
+    -> define default max. number of iterations for each fractal point
+*/
+
+#define ITER_MAX 155
+
+/* 
+  CONSTANTS 
+    -> define number of views (and their frames) kept for undo/redo
+*/
+
+#define HISTORY_MAX 16
+
+/* 
+  CONSTANTS 
+    -> define speculative render cache slots, one per likely next view:
+       view centered on the pointer, zoomed-out parent, and the four
+       neighbouring pan positions
+    -> define number of columns rendered per idle step
+*/
+
+#define PREFETCH_POINTER 0
+#define PREFETCH_PARENT  1
+#define PREFETCH_LEFT    2
+#define PREFETCH_RIGHT   3
+#define PREFETCH_UP      4
+#define PREFETCH_DOWN    5
+#define PREFETCH_MAX     6
+#define PREFETCH_COLUMNS 8
+
+/* 
+  CONSTANTS 
+    -> define smooth zoom frame rate and step per wheel notch/key repeat
+    -> define refinement tile size and the window size in tiles
+    -> define blur given to tiles with no previous frame data at all
+*/
+
+#define ZOOM_FPS          30
+#define ZOOM_STEP         0.85
+#define TILE_SIZE         40
+#define TILES_X           ((WIDTH + TILE_SIZE - 1) / TILE_SIZE)
+#define TILES_Y           ((HEIGHT + TILE_SIZE - 1) / TILE_SIZE)
+#define ZOOM_BLUR_MISSING 1000.0
+
+/* 
+  CONSTANTS 
+    -> define explorer preview resolution (1 point per block of pixels)
+    -> define number of columns rendered between checks for input
+*/
+
+#define PREVIEW_STEP      4
+#define EXPLORER_COLUMNS  16
+
+/* 
+  CONSTANTS 
+    -> define upper limits on render threads and NUMA nodes
+    -> define huge page size used to round frame memory, and the kind
+       of huge pages an arena ended up with
+*/
+
+#define RENDER_THREADS_MAX      64
+#define NUMA_NODES_MAX          64
+#define HUGE_PAGE_SIZE          ((size_t)2 << 20)
+#define ARENA_HUGE_NONE         0
+#define ARENA_HUGE_TRANSPARENT  1
+#define ARENA_HUGE_EXPLICIT     2
+
+/* 
+  CONSTANTS 
+    -> define the channels stored for each pixel of a frame: the color,
+       the escape iteration count (0 if never escaped), then any optional
+       accumulators chosen at compile time
+         -> FRACTAL_DISTANCE, distance estimate to the set boundary
+         -> FRACTAL_ORBIT_TRAP, closest approach of the orbit to the axes
+         -> e.g. make FEATURES="-DFRACTAL_DISTANCE -DFRACTAL_ORBIT_TRAP"
+    -> define the color schemes drawing those channels (banded if absent)
+    -> define the histogram equalized color scheme, applied to the stored
+       iteration counts once a frame is complete
+*/
+
+#define POINT_COLOR      0
+#define POINT_ITERATIONS 1
+
+#ifdef FRACTAL_DISTANCE
+#define POINT_DISTANCE  2
+#define POINT_TRAP_NEXT 3
+#else
+#define POINT_TRAP_NEXT 2
+#endif
+
+#ifdef FRACTAL_ORBIT_TRAP
+#define POINT_TRAP  POINT_TRAP_NEXT
+#define POINT_DEPTH (POINT_TRAP_NEXT + 1)
+#else
+#define POINT_DEPTH POINT_TRAP_NEXT
+#endif
+
+#define COLOR_DISTANCE  9
+#define COLOR_TRAP      10
+#define COLOR_EQUALIZED 11
+
+/* 
+  STRUCTURES
+    -> <FractalView>, fractal choice, its constants (<real>, <imag>),
+       max. number of iterations and the region currently on screen
+         -> each bound is a double-double: the <_lo> part holds the
+            digits below double precision for deep zooms
+    -> <FractalHistory>, ring of visited views with their rendered frames
+*/
+
+typedef struct
+  {
+    int    type;
+    int    color;
+    double real,
+           imag;
+    int    iterations;
+    double xmin,
+           ymin,
+           xmax,
+           ymax;
+    double xmin_lo,
+           ymin_lo,
+           xmax_lo,
+           ymax_lo;
+  } FractalView;
+
+typedef struct
+  {
+    FractalView   views[HISTORY_MAX];
+    unsigned long (*frames[HISTORY_MAX])[HEIGHT][POINT_DEPTH];
+    int           first,
+                  count,
+                  current;
+  } FractalHistory;
+
+/* 
+  STRUCTURES
+    -> <FractalPrefetch>, speculative frames rendered while idle
+         -> <used>, slot holds a candidate view
+         -> <ready>, slot frame is completely rendered
+         -> <pending>/<column>, slot and next column of the render in progress
+*/
+
+typedef struct
+  {
+    FractalView   views[PREFETCH_MAX];
+    unsigned long (*frames[PREFETCH_MAX])[HEIGHT][POINT_DEPTH];
+    int           used[PREFETCH_MAX],
+                  ready[PREFETCH_MAX],
+                  pending,
+                  column;
+  } FractalPrefetch;
+
+/* 
+  STRUCTURES
+    -> <FractalZoom>, progress of a frame refined after reprojection
+         -> <blur>, per-tile zoom error since the tile was last rendered
+            (0 when the tile is exact)
+         -> <scratch>, copy of the previous frame to resample from
+         -> <pending>, number of tiles still blurry
+*/
+
+typedef struct
+  {
+    double        blur[TILES_X][TILES_Y];
+    unsigned long (*scratch)[HEIGHT][POINT_DEPTH];
+    int           pending;
+  } FractalZoom;
+
+/* 
+  STRUCTURES
+    -> <FractalArena>, page-aligned frame memory from mmap
+         -> <huge>, one of the ARENA_HUGE_* values
+*/
+
+typedef struct
+  {
+    void   *base;
+    size_t size;
+    int    huge;
+  } FractalArena;
+
 /* GENERAL FUNCTION PROTOTYPES */
 
 /* XWindow stuff ... */
@@ -24,9 +208,55 @@ Display * openDisplay(void);
 void closeDisplay(Display *);
 int getScreen(Display *);
 void createWindow(Display *, int, Window *, char *);
-void showWindow(Display *, int, Window *, GC *, unsigned long [][HEIGHT][1], int, int);
+void showWindow(Display *, int, Window *, GC *, XImage **, unsigned long [][HEIGHT][POINT_DEPTH], FractalView *);
+void showExplorer(Display *, int, Window *, GC *, XImage **, unsigned long [][HEIGHT][POINT_DEPTH], FractalView *,
+                  Window *, GC *, XImage **, unsigned long [][HEIGHT][POINT_DEPTH], FractalView *);
 void createGC(Display *, Window *, GC *);
+void createImage(Display *, int, XImage **);
 
 /* Fractal stuff ... */
-void createFractal(int, int, unsigned long [][HEIGHT][1], int, int, int, int);
-void drawFractal(Display *, Window *, GC *, unsigned long [][HEIGHT][1]);
+void createFractal(FractalView *, unsigned long [][HEIGHT][POINT_DEPTH], int, int, int, int);
+void renderFractal(FractalView *, unsigned long [][HEIGHT][POINT_DEPTH]);
+void renderFractalColumns(FractalView *, unsigned long [][HEIGHT][POINT_DEPTH], int, int);
+void renderFractalTile(FractalView *, unsigned long [][HEIGHT][POINT_DEPTH], int, int, int, int);
+void renderFractalSampled(FractalView *, unsigned long [][HEIGHT][POINT_DEPTH], int, int, int, int, int);
+void equalizeFractal(FractalView *, unsigned long [][HEIGHT][POINT_DEPTH], int, int, int, int);
+int getRenderThreads(void);
+void getNewBounds(FractalView *, int, int, int, int);
+void zoomOutBounds(FractalView *);
+void panBounds(FractalView *, int, int);
+void zoomBounds(FractalView *, int, int, double);
+void getPoint(FractalView *, int, int, double *, double *);
+double getSpan(double, double, double, double);
+unsigned long packPointValue(double);
+double unpackPointValue(unsigned long);
+void addToBound(double *, double *, double);
+void drawFractal(Display *, Window *, GC *, XImage *, unsigned long [][HEIGHT][POINT_DEPTH]);
+
+/* History stuff ... */
+void createHistory(FractalHistory *);
+void freeHistory(FractalHistory *);
+void pushHistory(FractalHistory *, FractalView *, unsigned long [][HEIGHT][POINT_DEPTH]);
+int undoHistory(FractalHistory *, FractalView *, unsigned long [][HEIGHT][POINT_DEPTH]);
+int redoHistory(FractalHistory *, FractalView *, unsigned long [][HEIGHT][POINT_DEPTH]);
+
+/* Prefetch stuff ... */
+void createPrefetch(FractalPrefetch *);
+void freePrefetch(FractalPrefetch *);
+void planPrefetch(FractalPrefetch *, FractalView *, int, int);
+int stepPrefetch(FractalPrefetch *);
+void dropPrefetch(FractalPrefetch *);
+int fetchPrefetch(FractalPrefetch *, FractalView *, unsigned long [][HEIGHT][POINT_DEPTH]);
+
+/* Arena stuff ... */
+void createArena(FractalArena *, size_t);
+void freeArena(FractalArena *);
+int getNumaNodes(void);
+void setNodeAffinity(int);
+
+/* Smooth zoom stuff ... */
+void createZoom(FractalZoom *);
+void freeZoom(FractalZoom *);
+void clearZoom(FractalZoom *);
+void reprojectFrame(FractalZoom *, FractalView *, FractalView *, unsigned long [][HEIGHT][POINT_DEPTH]);
+int refineFrame(FractalZoom *, FractalView *, unsigned long [][HEIGHT][POINT_DEPTH], double);
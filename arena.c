@@ -0,0 +1,192 @@
+/*
+ * arena.c: X-Fractals / huge-page backed frame memory and NUMA node placement
+ *
+ * Authored by Parmjit Virk (2017)
+ *
+ * Licensed under the MIT license as per the Open Source Initiative 2017.
+ * See the LICENSE file for the complete license information,
+ * or visit https://opensource.org/licenses/MIT for details.
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <X11/Xlib.h>
+#include "Xfractals.h"
+
+/* Define local function prototypes ... */
+int readNodeCpus(int, cpu_set_t *);
+
+/*
+   Retain the node CPU masks in memory, read once on first use
+     -> static vars
+*/
+
+static cpu_set_t node_cpus[NUMA_NODES_MAX];
+static int       node_count = 0;
+
+/*
+  Function createArena
+    -> Reserve <size> bytes of frame memory, rounded up to huge pages ...
+      -> explicit huge pages first, then transparent huge pages
+      -> pages are not touched here, so each one is placed on the NUMA
+         node of the thread that first writes it (first-touch)
+      -> with more than one NUMA node, 4K pages only: a node's share of
+         a frame (its threads' column bands) is smaller than one huge
+         page, which would land whole on the node that touched it first
+*/
+void createArena(FractalArena *arena, size_t size)
+  {
+    arena->size = (((size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE);
+    arena->huge = (getNumaNodes() > 1) ? ARENA_HUGE_NONE : ARENA_HUGE_EXPLICIT;
+    arena->base = MAP_FAILED;
+
+    if (arena->huge == ARENA_HUGE_EXPLICIT)
+      {
+        arena->base = mmap(NULL, arena->size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      }
+
+    if (arena->base == MAP_FAILED)
+      {
+        arena->base = mmap(NULL, arena->size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (arena->base == MAP_FAILED)
+          {
+            /* Can't hold any frames, so notify and quit ... */
+
+            printf("Could not allocate frame memory.\n");
+            exit(1);
+          }
+
+        if (arena->huge == ARENA_HUGE_NONE)
+          {
+            /* Placement matters more than TLB reach, keep small pages */
+
+            madvise(arena->base, arena->size, MADV_NOHUGEPAGE);
+          }
+        else
+          {
+            /* No reserved huge pages, so ask for transparent ones ... */
+
+            arena->huge = ARENA_HUGE_TRANSPARENT;
+            if (madvise(arena->base, arena->size, MADV_HUGEPAGE) != 0)
+              {
+                arena->huge = ARENA_HUGE_NONE;
+              }
+          }
+      }
+
+    return;
+  }
+
+/*
+  Function freeArena
+    -> Return the arena's pages to the system
+*/
+void freeArena(FractalArena *arena)
+  {
+    munmap(arena->base, arena->size);
+    arena->base = NULL;
+    arena->size = 0;
+
+    return;
+  }
+
+/*
+  Function getNumaNodes
+    -> Return the number of NUMA nodes with CPUs (at least 1) ...
+      -> must be called once from the main thread before any worker
+         calls setNodeAffinity
+*/
+int getNumaNodes(void)
+  {
+    if (node_count == 0)
+      {
+        while ((node_count < NUMA_NODES_MAX) && (readNodeCpus(node_count, &node_cpus[node_count]) == 1))
+          {
+            node_count++;
+          }
+
+        if (node_count == 0)
+          {
+            /* No NUMA information, treat the machine as one node */
+
+            CPU_ZERO(&node_cpus[0]);
+            node_count = -1;
+          }
+      }
+
+    return ((node_count > 0) ? node_count : 1);
+  }
+
+/*
+  Function setNodeAffinity
+    -> Restrict the calling thread to the CPUs of NUMA node <node> ...
+      -> does nothing if the node layout is unknown
+*/
+void setNodeAffinity(int node)
+  {
+    if ((node_count > 0) && (node < node_count))
+      {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &node_cpus[node]);
+      }
+
+    return;
+  }
+
+/*
+  Function readNodeCpus
+    -> Parse the CPU list of NUMA node <node> from sysfs (e.g. "0-3,8-11")
+      -> returns 0 if the node does not exist or has no CPUs
+*/
+int readNodeCpus(int node, cpu_set_t *cpus)
+  {
+    FILE *file;
+    char path[64];
+    int  first,
+         last,
+         cpu,
+         found;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+
+    file = fopen(path, "r");
+    if (file == NULL)
+      {
+        return (0);
+      }
+
+    CPU_ZERO(cpus);
+    found = 0;
+
+    while (fscanf(file, "%d", &first) == 1)
+      {
+        last = first;
+        if (fscanf(file, "-%d", &last) != 1)
+          {
+            last = first;
+          }
+
+        for (cpu = first ; (cpu <= last) && (cpu < CPU_SETSIZE) ; cpu++)
+          {
+            CPU_SET(cpu, cpus);
+            found = 1;
+          }
+
+        if (fgetc(file) != ',')
+          {
+            break;
+          }
+      }
+
+    fclose(file);
+
+    return (found);
+  }
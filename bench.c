@@ -0,0 +1,137 @@
+/*
+ * bench.c: X-Fractals / compare page faults and throughput of arena and malloc frame memory
+ *
+ * Authored by Parmjit Virk (2017)
+ *
+ * Licensed under the MIT license as per the Open Source Initiative 2017.
+ * See the LICENSE file for the complete license information,
+ * or visit https://opensource.org/licenses/MIT for details.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <X11/Xlib.h>
+#include "Xfractals.h"
+
+/*
+  CONSTANTS
+    -> define default strip length, in windows, of the benchmark frame
+*/
+
+#define BENCH_FRAMES 64
+
+/* Define local function prototypes ... */
+void runBench(char *, unsigned long [][HEIGHT][POINT_DEPTH], int);
+double getBenchSeconds(void);
+
+/*
+  Benchmark entry point ...
+    -> usage: bench [frames]
+    -> renders one frame <frames> windows wide, side by side, first into
+       plain malloc memory and then into the frame arena (huge pages
+       unless there are several NUMA nodes)
+*/
+int main(int argc, char *argv[])
+  {
+    FractalArena arena;
+
+    unsigned long (*fractal_points)[HEIGHT][POINT_DEPTH];
+
+    size_t size;
+
+    int frames;
+
+    frames = (argc > 1) ? atoi(argv[1]) : BENCH_FRAMES;
+    frames = (frames < 1) ? 1 : frames;
+    size = (frames * sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+
+    printf("\n%d x %d pixels, %d render threads, %d NUMA nodes\n\n",
+           (frames * WIDTH), HEIGHT, getRenderThreads(), getNumaNodes());
+
+    /* Plain malloc ... */
+
+    fractal_points = malloc(size);
+    if (fractal_points == NULL)
+      {
+        printf("Could not allocate frame memory.\n");
+        exit(1);
+      }
+
+    runBench("malloc", fractal_points, frames);
+    free(fractal_points);
+
+    /* Frame arena ... */
+
+    createArena(&arena, size);
+    runBench((arena.huge == ARENA_HUGE_EXPLICIT) ? "arena (explicit huge pages)" :
+             (arena.huge == ARENA_HUGE_TRANSPARENT) ? "arena (transparent huge pages)" :
+             "arena (4K pages)", arena.base, frames);
+    freeArena(&arena);
+
+    printf("\n");
+
+    return (0);
+  }
+
+/*
+  Function runBench
+    -> Render the strip twice into <fractal_points> and report ...
+      -> first pass pays for page faults (cold), second does not (warm)
+*/
+void runBench(char *name, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], int frames)
+  {
+    FractalView   view;
+    struct rusage usage;
+
+    double start,
+           seconds;
+
+    long   faults;
+
+    int    pass,
+           frame;
+
+    for (pass = 0 ; pass < 2 ; pass++)
+      {
+        view.type = 1;
+        view.color = 1;
+        getNewBounds(&view, -1, 0, 0, 0);
+
+        getrusage(RUSAGE_SELF, &usage);
+        faults = (usage.ru_minflt + usage.ru_majflt);
+        start = getBenchSeconds();
+
+        for (frame = 0 ; frame < frames ; frame++)
+          {
+            /* Each window of the strip continues where the last one ended */
+            renderFractal(&view, (fractal_points + (frame * WIDTH)));
+            panBounds(&view, 2, 0);
+          }
+
+        seconds = (getBenchSeconds() - start);
+        getrusage(RUSAGE_SELF, &usage);
+        faults = ((usage.ru_minflt + usage.ru_majflt) - faults);
+
+        printf("%-32s %s  %8ld page faults  %8.3f s  %8.2f Mpixel/s\n",
+               name, (pass == 0) ? "cold" : "warm", faults, seconds,
+               (((double)frames * WIDTH * HEIGHT) / seconds) / 1e6);
+      }
+
+    return;
+  }
+
+/*
+  Function getBenchSeconds
+    -> Return a monotonic time stamp in seconds
+*/
+double getBenchSeconds(void)
+  {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec + (now.tv_nsec / 1e9));
+  }
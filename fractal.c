@@ -9,23 +9,183 @@
  *
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <math.h>
+#include <float.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/Xos.h>
 #include "Xfractals.h"
 
-/* Define max. number of iterations for each fractal point ... */
+/* 
+  Define iteration lanes and arithmetic precision levels ...
+    -> LANE_COUNT points of a column are iterated side by side, so that
+       the compiler can vectorise the fractal routines
+    -> float lanes are half the width of double lanes, so twice as many
+       points fit in each vector register
+    -> double-double keeps each value as an unevaluated sum hi + lo of
+       two doubles (~106 bits), for zooms past the double limit
+    -> PRECISION_MARGIN is the guard factor applied to machine epsilon
+       before a pixel spacing is considered safe for double precision;
+       float instead allows for the error doubling every iteration
+    -> DD_SPLITTER is 2^27 + 1, used to split a double into two halves
+       whose products are exact
+*/
+
+#define LANE_COUNT              16
+#define PRECISION_FLOAT         1
+#define PRECISION_DOUBLE        2
+#define PRECISION_DOUBLE_DOUBLE 3
+#define PRECISION_MARGIN        256.0
+#define DD_SPLITTER             134217729.0
+
+/* 
+  Define the work handed to one render thread ...
+    -> sample columns <px_start> up to <px_end> of rows <py_start> up to 
+       <py_end>, one point per <step> x <step> block
+*/
+
+typedef struct
+  {
+    FractalView   *view;
+    unsigned long (*fractal_points)[HEIGHT][POINT_DEPTH];
+    int           px_start,
+                  px_end,
+                  py_start,
+                  py_end,
+                  step;
+  } FractalTask;
+
+/*
+  Define the work handed to one histogram equalization thread ...
+    -> the same column band of the rectangle as its render thread
+    -> <histograms>, one partial histogram of <bins> counts per thread,
+       reduced into the first one
+    -> <palette>, color of each iteration count once the histogram
+       is known
+*/
+
+typedef struct
+  {
+    unsigned long     (*fractal_points)[HEIGHT][POINT_DEPTH];
+    unsigned int      *histograms;
+    unsigned long     *palette;
+    pthread_barrier_t *barrier;
+    int               thread,
+                      threads,
+                      bins,
+                      px_start,
+                      px_end,
+                      py_start,
+                      py_end;
+  } FractalEqualizeTask;
+
+/*
+  Define the pool of render threads, started once and kept for the
+  life of the program ...
+    -> <workers>, threads actually started (0 or 1 renders inline)
+    -> <routine>, body run by every worker in the current round, each on
+       its own entry of the <tasks> array (entries <task_size> apart)
+    -> <round>, count of rounds handed out; <busy>, workers still on
+       the current round
+    -> <next>, index given to the next worker to start
+*/
+
+typedef struct
+  {
+    pthread_mutex_t lock;
+    pthread_cond_t  start,
+                    done;
+    void            *(*routine)(void *);
+    void            *tasks;
+    size_t          task_size;
+    unsigned long   round;
+    int             workers,
+                    busy,
+                    next;
+  } FractalPool;
+
+/* 
+   Retain the pool in memory, started on first use
+     -> static var
+*/
+
+static FractalPool pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                           PTHREAD_COND_INITIALIZER, NULL, NULL, 0, 0, 0, 0, 0};
+
+/*
+  Define the per-lane results of one group of iterated points ...
+    -> <iter_count[]>, escape iteration, or 0 if the point never escaped
+    -> with FRACTAL_DISTANCE, the derivative <dx[]>, <dy[]> of z is carried
+       alongside it as dz' = ((<deriv_a> * z) + <deriv_b>) * dz + <deriv_c>
+       (complex <deriv_a>, <deriv_b>), and <distance[]> receives the
+       distance estimate |z| log|z| / 2|dz| at escape (0 if never escaped)
+    -> with FRACTAL_ORBIT_TRAP, <trap[]> receives the closest approach of
+       the orbit to the real or imaginary axis (Pickover stalks)
+*/
 
-#define ITER_MAX 155
+typedef struct
+  {
+    int    iter_count[LANE_COUNT];
+#ifdef FRACTAL_DISTANCE
+    double deriv_a_re,
+           deriv_a_im,
+           deriv_b_re,
+           deriv_b_im,
+           deriv_c;
+    double dx[LANE_COUNT],
+           dy[LANE_COUNT],
+           distance[LANE_COUNT];
+#endif
+#ifdef FRACTAL_ORBIT_TRAP
+    double trap[LANE_COUNT];
+#endif
+  } FractalTrace;
 
 /* Define local function prototypes ... */
 /* TODO: put these in a separate library header file */
 
-void getNewBounds(int, int, int, int, int, double *, double *, double *, double *);
-void calculateMandelbrot(double, double, double *, double *, double, double, double, double);
-void calculateJulia(double, double, double *, double *, double, double, double, double);
-void calculateSpiral(double, double, double *, double *, double, double, double, double);
+void renderFractalBand(FractalView *, unsigned long [][HEIGHT][POINT_DEPTH], int, int, int, int, int);
+void *renderFractalThread(void *);
+void *equalizeFractalThread(void *);
+int  startRenderPool(int);
+void runRenderPool(void *(*)(void *), void *, size_t);
+void *renderPoolThread(void *);
+
+int  selectPrecision(FractalView *, double);
+static inline void traceStart(FractalTrace *, int, double, double);
+static inline void traceStep(FractalTrace *, int, double, double);
+static inline void traceEscape(FractalTrace *, int, double, double);
+static inline void traceOrbit(FractalTrace *, int, double, double);
+void iterateDouble(void (*)(int, double [], double [], double [], double [], double, double), 
+                   int, double [], double [], double, double, double, int, FractalTrace *);
+void iterateFloat(void (*)(int, float [], float [], float [], float [], float, float), 
+                  int, float [], float [], float, float, float, int, FractalTrace *);
+void iterateDoubleDouble(void (*)(int, double [], double [], double [], double [], 
+                                  double [], double [], double [], double [], double, double),
+                         int, double [], double [], double [], double [], 
+                         double, double, double, int, FractalTrace *);
+void calculateMandelbrot(int, double [], double [], double [], double [], double, double);
+void calculateJulia(int, double [], double [], double [], double [], double, double);
+void calculateSpiral(int, double [], double [], double [], double [], double, double);
+void calculateMandelbrotFloat(int, float [], float [], float [], float [], float, float);
+void calculateJuliaFloat(int, float [], float [], float [], float [], float, float);
+void calculateSpiralFloat(int, float [], float [], float [], float [], float, float);
+void calculateMandelbrotDD(int, double [], double [], double [], double [], 
+                           double [], double [], double [], double [], double, double);
+void calculateJuliaDD(int, double [], double [], double [], double [], 
+                      double [], double [], double [], double [], double, double);
+void calculateSpiralDD(int, double [], double [], double [], double [], 
+                       double [], double [], double [], double [], double, double);
+static inline void ddTwoSum(double, double, double *, double *);
+static inline void ddQuickTwoSum(double, double, double *, double *);
+static inline void ddTwoProd(double, double, double *, double *);
+static inline void ddAdd(double, double, double, double, double *, double *);
+static inline void ddMul(double, double, double, double, double *, double *);
+static inline void ddMulD(double, double, double, double *, double *);
 /* TODO: refactor color routines as void to improve performance */
 unsigned long calculateColorBanded(int, int, int);
 unsigned long calculateColorBlueDark(int, int, int);
@@ -35,86 +195,569 @@ unsigned long calculateColorRedDark(int, int, int);
 unsigned long calculateColorGreenLight(int, int, int);
 unsigned long calculateColorGreenBanded(int, int, int);
 unsigned long calculateColorBlueGreenBanded(int, int, int);
+unsigned long calculateColorDistance(double, double);
+unsigned long calculateColorTrap(double);
+unsigned long calculateColorEqualized(double);
 
 /*
   Function createFractal
-   -> Generate/store pixel color data for a given fractal and region ...
+   -> Move a view to a new region and render it ...
 */
 void createFractal
- (int fractal_type, int fractal_color, unsigned long fractal_points[][HEIGHT][1], 
+ (FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], 
   int px1, int py1, int px2, int py2)
+  {
+    getNewBounds(view, px1, py1, px2, py2);
+    renderFractal(view, fractal_points);
+
+    return;
+  }
+
+/*
+  Function renderFractal
+   -> Generate/store pixel color data for a given fractal and region ...
+*/
+void renderFractal(FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH])
+  {
+    renderFractalColumns(view, fractal_points, 0, WIDTH);
+    equalizeFractal(view, fractal_points, 0, WIDTH, 0, HEIGHT);
+
+    return;
+  }
+
+/*
+  Function renderFractalColumns
+   -> Generate/store pixel color data for columns <px_start> up to <px_end> ...
+     -> lets callers spread a render over several short steps
+*/
+void renderFractalColumns
+ (FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], int px_start, int px_end)
+  {
+    renderFractalTile(view, fractal_points, px_start, px_end, 0, HEIGHT);
+
+    return;
+  }
+
+/*
+  Function renderFractalTile
+   -> Generate/store pixel color data for a rectangle of the window ...
+     -> columns <px_start> up to <px_end>, rows <py_start> up to <py_end>
+*/
+void renderFractalTile
+ (FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], 
+  int px_start, int px_end, int py_start, int py_end)
+  {
+    renderFractalSampled(view, fractal_points, px_start, px_end, py_start, py_end, 1);
+
+    return;
+  }
+
+/*
+  Function renderFractalSampled
+   -> Generate/store pixel color data at reduced resolution ...
+     -> only every <step>-th point of the rectangle is iterated, and its
+        color fills the surrounding <step> x <step> block
+     -> a <step> of 1 renders every pixel
+     -> the window is split into one fixed column band per render thread;
+        each thread only ever writes its own band, so under first-touch
+        (and the 4K pages of a multi-node arena) the band's pages live on
+        that thread's NUMA node, bar the page shared at each band edge
+*/
+void renderFractalSampled
+ (FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], 
+  int px_start, int px_end, int py_start, int py_end, int step)
+  {
+    FractalTask task[RENDER_THREADS_MAX];
+
+    int threads,
+        samples,
+        first,
+        last,
+        t;
+
+    threads = getRenderThreads();
+
+    if (threads == 1)
+      {
+        renderFractalBand(view, fractal_points, px_start, px_end, py_start, py_end, step);
+        return;
+      }
+
+    /* 
+      Hand each thread the sample columns falling in its band ...
+        -> band edges are snapped to the sample grid so that blocks
+           are never split between two threads
+    */
+
+    samples = (((px_end - px_start) + step - 1) / step);
+
+    for (t = 0 ; t < threads ; t++)
+      {
+        first = ((((t * WIDTH) / threads) - px_start) + step - 1);
+        last = (((((t + 1) * WIDTH) / threads) - px_start) + step - 1);
+        first = (first < 0) ? 0 : (first / step);
+        last = (last < 0) ? 0 : (last / step);
+        first = (first > samples) ? samples : first;
+        last = (last > samples) ? samples : last;
+
+        task[t].view = view;
+        task[t].fractal_points = fractal_points;
+        task[t].px_start = (px_start + (first * step));
+        task[t].px_end = (px_start + (last * step));
+        task[t].px_end = (task[t].px_end > px_end) ? px_end : task[t].px_end;
+        task[t].py_start = py_start;
+        task[t].py_end = py_end;
+        task[t].step = step;
+      }
+
+    runRenderPool(&renderFractalThread, task, sizeof(FractalTask));
+
+    return;
+  }
+
+/*
+  Function renderFractalThread
+   -> Render thread body: render this thread's band (may be empty) ...
+*/
+void *renderFractalThread(void *arg)
+  {
+    FractalTask *task;
+
+    task = (FractalTask *)arg;
+
+    renderFractalBand(task->view, task->fractal_points, task->px_start, task->px_end, 
+                      task->py_start, task->py_end, task->step);
+
+    return (NULL);
+  }
+
+/*
+  Function equalizeFractal
+   -> Recolor a rendered rectangle by histogram equalization ...
+     -> only for the equalized color scheme, otherwise does nothing
+     -> a post-pass over the stored iteration counts, so it must run once
+        the whole rectangle is rendered (or reprojected)
+     -> each thread counts its own column band into a partial histogram,
+        the partials are summed in parallel (one slice of bins each), a
+        prefix sum turns the total into a palette, and each thread then
+        recolors its band: O(pixels + iterations) overall
+*/
+void equalizeFractal
+ (FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH],
+  int px_start, int px_end, int py_start, int py_end)
+  {
+    FractalEqualizeTask task[RENDER_THREADS_MAX];
+    pthread_barrier_t   barrier;
+
+    unsigned int  *histograms;
+    unsigned long *palette;
+
+    int threads,
+        bins,
+        t;
+
+    if (view->color != COLOR_EQUALIZED)
+      {
+        return;
+      }
+
+    /* 
+      Counts run from 0 (never escaped) to one past the iteration limit
+        -> every thread of the pool takes part in the reduction, even
+           with no columns, so the barrier counts exactly those started
+    */
+
+    threads = getRenderThreads();
+    bins = (view->iterations + 2);
+
+    histograms = malloc(threads * bins * sizeof(unsigned int));
+    palette = malloc(bins * sizeof(unsigned long));
+    if ((histograms == NULL) || (palette == NULL))
+      {
+        /* Can't equalize colors, so notify and quit ... */
+
+        printf("Could not allocate color histogram.\n");
+        exit(1);
+      }
+
+    pthread_barrier_init(&barrier, NULL, threads);
+
+    for (t = 0 ; t < threads ; t++)
+      {
+        task[t].fractal_points = fractal_points;
+        task[t].histograms = histograms;
+        task[t].palette = palette;
+        task[t].barrier = &barrier;
+        task[t].thread = t;
+        task[t].threads = threads;
+        task[t].bins = bins;
+        task[t].px_start = ((t * WIDTH) / threads);
+        task[t].px_end = (((t + 1) * WIDTH) / threads);
+        task[t].px_start = (task[t].px_start < px_start) ? px_start : task[t].px_start;
+        task[t].px_end = (task[t].px_end > px_end) ? px_end : task[t].px_end;
+        task[t].py_start = py_start;
+        task[t].py_end = py_end;
+      }
+
+    runRenderPool(&equalizeFractalThread, task, sizeof(FractalEqualizeTask));
+
+    pthread_barrier_destroy(&barrier);
+    free(histograms);
+    free(palette);
+
+    return;
+  }
+
+/*
+  Function equalizeFractalThread
+   -> Equalization thread body: count, reduce, (prefix sum), recolor ...
+*/
+void *equalizeFractalThread(void *arg)
+  {
+    FractalEqualizeTask *task;
+
+    unsigned int  *histogram,
+                  *total;
+    unsigned long count;
+
+    int px,
+        py,
+        bin,
+        bin_end,
+        t;
+
+    task = (FractalEqualizeTask *)arg;
+    histogram = (task->histograms + (task->thread * task->bins));
+    total = task->histograms;
+
+    /* Partial histogram of this band ... */
+
+    for (bin = 0 ; bin < task->bins ; bin++)
+      {
+        histogram[bin] = 0;
+      }
+
+    for (px = task->px_start ; px < task->px_end ; px++)
+      {
+        for (py = task->py_start ; py < task->py_end ; py++)
+          {
+            count = task->fractal_points[px][py][POINT_ITERATIONS];
+            histogram[(count < task->bins) ? count : (task->bins - 1)]++;
+          }
+      }
+
+    pthread_barrier_wait(task->barrier);
+
+    /* Sum this thread's slice of bins across all partials, into the first */
+
+    bin_end = (((task->thread + 1) * task->bins) / task->threads);
+
+    for (bin = ((task->thread * task->bins) / task->threads) ; bin < bin_end ; bin++)
+      {
+        for (t = 1 ; t < task->threads ; t++)
+          {
+            total[bin] += task->histograms[(t * task->bins) + bin];
+          }
+      }
+
+    pthread_barrier_wait(task->barrier);
+
+    /*
+      Prefix sum over the escaped counts, mapped to palette colors ...
+        -> done by one thread, there are only as many bins as iterations
+        -> points that never escaped stay black
+        -> if none escaped there is nothing to spread, the whole
+           rectangle stays black
+    */
+
+    if (task->thread == 0)
+      {
+        total[0] = 0;
+        for (bin = 1 ; bin < task->bins ; bin++)
+          {
+            total[bin] += total[bin - 1];
+          }
+
+        for (bin = 0 ; bin < task->bins ; bin++)
+          {
+            task->palette[bin] = ((bin == 0) || (total[task->bins - 1] == 0)) ? 0 :
+              calculateColorEqualized((double)total[bin] / total[task->bins - 1]);
+          }
+      }
+
+    pthread_barrier_wait(task->barrier);
+
+    /* Recolor this band ... */
+
+    for (px = task->px_start ; px < task->px_end ; px++)
+      {
+        for (py = task->py_start ; py < task->py_end ; py++)
+          {
+            count = task->fractal_points[px][py][POINT_ITERATIONS];
+            task->fractal_points[px][py][POINT_COLOR] =
+              task->palette[(count < task->bins) ? count : (task->bins - 1)];
+          }
+      }
+
+    return (NULL);
+  }
+
+/*
+  Function getRenderThreads
+   -> Return the number of render threads (one per online CPU) ...
+     -> must be called once from the main thread before rendering
+     -> starts the pool on first call; if the system runs out of threads
+        the count is the number actually started
+*/
+int getRenderThreads(void)
+  {
+    /* 
+       Retain the count in memory even after function terminates! 
+         -> static var
+    */
+
+    static int threads = 0;
+
+    if (threads == 0)
+      {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (threads < 1) ? 1 : threads;
+        threads = (threads > RENDER_THREADS_MAX) ? RENDER_THREADS_MAX : threads;
+        getNumaNodes();
+        threads = startRenderPool(threads);
+      }
+
+    return (threads);
+  }
+
+/*
+  Function startRenderPool
+   -> Start up to <threads> pool workers and return how many render ...
+     -> a single thread renders inline, without a pool
+     -> workers take their index once all have been started, so each
+        knows the final count when picking its NUMA node
+*/
+int startRenderPool(int threads)
+  {
+    pthread_t thread;
+
+    int t;
+
+    if (threads == 1)
+      {
+        return (1);
+      }
+
+    pthread_mutex_lock(&pool.lock);
+
+    for (t = 0 ; t < threads ; t++)
+      {
+        if (pthread_create(&thread, NULL, &renderPoolThread, NULL) != 0)
+          {
+            break;
+          }
+
+        pthread_detach(thread);
+        pool.workers++;
+      }
+
+    /* Wait until every worker is ready for the first round */
+
+    while (pool.next < pool.workers)
+      {
+        pthread_cond_wait(&pool.done, &pool.lock);
+      }
+
+    pthread_mutex_unlock(&pool.lock);
+
+    return ((pool.workers > 1) ? pool.workers : 1);
+  }
+
+/*
+  Function runRenderPool
+   -> Run <routine> once per render thread and wait for all of them ...
+     -> worker <t> is handed entry <t> of the <tasks> array
+     -> called from one thread at a time
+*/
+void runRenderPool(void *(*routine)(void *), void *tasks, size_t task_size)
+  {
+    if (pool.workers <= 1)
+      {
+        routine(tasks);
+        return;
+      }
+
+    pthread_mutex_lock(&pool.lock);
+
+    pool.routine = routine;
+    pool.tasks = tasks;
+    pool.task_size = task_size;
+    pool.busy = pool.workers;
+    pool.round++;
+    pthread_cond_broadcast(&pool.start);
+
+    while (pool.busy > 0)
+      {
+        pthread_cond_wait(&pool.done, &pool.lock);
+      }
+
+    pthread_mutex_unlock(&pool.lock);
+
+    return;
+  }
+
+/*
+  Function renderPoolThread
+   -> Pool worker body: move to this thread's NUMA node once, then run
+      each round's routine on this thread's task ...
+*/
+void *renderPoolThread(void *arg)
+  {
+    void *(*routine)(void *);
+    void *task;
+
+    unsigned long round;
+
+    int t;
+
+    pthread_mutex_lock(&pool.lock);
+    t = pool.next++;
+    round = pool.round;
+    setNodeAffinity((t * getNumaNodes()) / pool.workers);
+
+    if (pool.next == pool.workers)
+      {
+        pthread_cond_signal(&pool.done);
+      }
+
+    for (;;)
+      {
+        while (pool.round == round)
+          {
+            pthread_cond_wait(&pool.start, &pool.lock);
+          }
+
+        round = pool.round;
+        routine = pool.routine;
+        task = ((char *)pool.tasks + (t * pool.task_size));
+        pthread_mutex_unlock(&pool.lock);
+
+        routine(task);
+
+        pthread_mutex_lock(&pool.lock);
+        pool.busy--;
+        if (pool.busy == 0)
+          {
+            pthread_cond_signal(&pool.done);
+          }
+      }
+
+    return (NULL);
+  }
+
+/*
+  Function renderFractalBand
+   -> Render thread work: sampled render of a column range ...
+*/
+void renderFractalBand
+ (FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], 
+  int px_start, int px_end, int py_start, int py_end, int step)
   {
     /* <*fractalRoutine>, pointer to a function body  */
+    /* <*fractalRoutineFloat>, pointer to the single precision twin */
+    /* <*fractalRoutineDD>, pointer to the double-double twin */
     /* <*fractalColorRoutine>, pointer to a function body  */
 
-    void          (*fractalRoutine)(double, double, double *, double *, double, double, double, double);
+    void          (*fractalRoutine)(int, double [], double [], double [], double [], double, double);
+    void          (*fractalRoutineFloat)(int, float [], float [], float [], float [], float, float);
+    void          (*fractalRoutineDD)(int, double [], double [], double [], double [], 
+                                      double [], double [], double [], double [], double, double);
     unsigned long (*fractalColorRoutine)(int, int, int);
 
     double  dist_max,
             real, 
             imag;
 
-    double  xn, 
-            xnew,
-            yn, 
-            ynew,
-            x_inc, 
-            y_inc, 
-            orig1, 
-            orig2,
-            dist;
+    double  x_inc, 
+            y_inc;
 
-    int     px, 
-            py, 
-            iter_count;
+    /* Per-lane starting points and resulting iteration counts ... */
 
-    /* 
-       Retain these doubles in memory even after function terminates! 
-         -> static vars
-    */
+    double  orig1[LANE_COUNT],
+            orig2[LANE_COUNT];
+    float   orig1_f[LANE_COUNT],
+            orig2_f[LANE_COUNT];
+    double  orig1_lo[LANE_COUNT],
+            orig2_lo[LANE_COUNT];
+    FractalTrace trace;
 
-    static double xmin,
-                  xmax,
-                  ymin,
-                  ymax;
+    int     px, 
+            py, 
+            bx,
+            by,
+            lane,
+            lanes,
+            precision;
 
-    /* 
-       Triplet of color data, positive values only!  
-         -> unsigned data type
-    */
+    unsigned long color;
 
-    unsigned long index_r,
-                  index_g,
-                  index_b;
+    double  xmin,
+            ymax;
 
     /* Set appropriate values based on user choices ... */
 
-    switch(fractal_type) 
+    switch(view->type) 
       {
         case 1:
           /* Assign the function pointer to a function body */
           fractalRoutine = &calculateMandelbrot;
+          fractalRoutineFloat = &calculateMandelbrotFloat;
+          fractalRoutineDD = &calculateMandelbrotDD;
           dist_max = 2.0;
-          real = 0.0;
-          imag = 0.0;
+#ifdef FRACTAL_DISTANCE
+          /* dz' = 2z dz + 1 */
+          trace.deriv_a_re = 2.0;
+          trace.deriv_a_im = 0.0;
+          trace.deriv_b_re = 0.0;
+          trace.deriv_b_im = 0.0;
+          trace.deriv_c = 1.0;
+#endif
         break;
         case 2:
           fractalRoutine = &calculateJulia;
+          fractalRoutineFloat = &calculateJuliaFloat;
+          fractalRoutineDD = &calculateJuliaDD;
           dist_max = 2.0;
-          real = 0.3;
-          imag = 0.6;
+#ifdef FRACTAL_DISTANCE
+          /* dz' = 2z dz */
+          trace.deriv_a_re = 2.0;
+          trace.deriv_a_im = 0.0;
+          trace.deriv_b_re = 0.0;
+          trace.deriv_b_im = 0.0;
+          trace.deriv_c = 0.0;
+#endif
         break;
         case 3:
+        default:
           fractalRoutine = &calculateSpiral;
+          fractalRoutineFloat = &calculateSpiralFloat;
+          fractalRoutineDD = &calculateSpiralDD;
           dist_max = 4.0;
-          real = 0.85;
-          imag = 0.6;
+#ifdef FRACTAL_DISTANCE
+          /* z' = c(z - z^2), so dz' = (-2cz + c) dz */
+          trace.deriv_a_re = (-2.0 * view->real);
+          trace.deriv_a_im = (-2.0 * view->imag);
+          trace.deriv_b_re = view->real;
+          trace.deriv_b_im = view->imag;
+          trace.deriv_c = 0.0;
+#endif
         break;
       }
 
-    switch(fractal_color) 
+    switch(view->color) 
       {
         case 1:
+        default:
           /* Assign the function pointer to a function body */
           fractalColorRoutine = &calculateColorBanded;
         break;
@@ -141,81 +784,459 @@ void createFractal
         break;
       }
 
-    /* Determine fractal bounds ... */
+    /* Pick up fractal constants, bounds and the cheapest safe precision ... */
+
+    real = view->real;
+    imag = view->imag;
+    xmin = view->xmin;
+    ymax = view->ymax;
+    precision = selectPrecision(view, dist_max);
+
+    /* 
+      Generate fractal color data ...
+        -> iterate LANE_COUNT points of each column at a time
+        -> store in <fractal_points> array
+    */
+
+    x_inc = (getSpan(view->xmax, view->xmax_lo, view->xmin, view->xmin_lo) / WIDTH);   
+    y_inc = (getSpan(view->ymax, view->ymax_lo, view->ymin, view->ymin_lo) / HEIGHT);
+
+    for (px = px_start ; px < px_end ; px += step)
+      {
+        for (py = py_start ; py < py_end ; py += (LANE_COUNT * step))
+          {
+            lanes = (((py_end - py) + step - 1) / step);
+            lanes = (lanes < LANE_COUNT) ? lanes : LANE_COUNT;
+
+            for (lane = 0 ; lane < lanes ; lane++)
+              {
+                orig1[lane] = (xmin + (px * x_inc));
+                orig2[lane] = (ymax - ((py + (lane * step)) * y_inc));
+              }
+
+            if (precision == PRECISION_FLOAT)
+              {
+                for (lane = 0 ; lane < lanes ; lane++)
+                  {
+                    orig1_f[lane] = (float)orig1[lane];
+                    orig2_f[lane] = (float)orig2[lane];
+                  }
+
+                iterateFloat(fractalRoutineFloat, lanes, orig1_f, orig2_f, 
+                             (float)real, (float)imag, (float)dist_max, view->iterations, &trace);
+              }
+            else if (precision == PRECISION_DOUBLE)
+              {
+                iterateDouble(fractalRoutine, lanes, orig1, orig2, 
+                              real, imag, dist_max, view->iterations, &trace);
+              }
+            else
+              {
+                /* Rebuild the points from the double-double bounds */
+
+                for (lane = 0 ; lane < lanes ; lane++)
+                  {
+                    ddAdd(view->xmin, view->xmin_lo, (px * x_inc), 0, &orig1[lane], &orig1_lo[lane]);
+                    ddAdd(view->ymax, view->ymax_lo, -((py + (lane * step)) * y_inc), 0, 
+                          &orig2[lane], &orig2_lo[lane]);
+                  }
+
+                iterateDoubleDouble(fractalRoutineDD, lanes, orig1, orig1_lo, orig2, orig2_lo,
+                                    real, imag, dist_max, view->iterations, &trace);
+              }
+
+            /* 
+              Build a 24-bit long unsigned value from the color triplets ...
+                -> required by a TrueColor visual type to render color!
+                -> points that never escaped have a count of 0 (black)
+                -> the iteration count and optional channels are stored
+                   next to the color
+            */
+
+            for (lane = 0 ; lane < lanes ; lane++)
+              {
+                color = fractalColorRoutine(trace.iter_count[lane], trace.iter_count[lane], trace.iter_count[lane]);
+#ifdef FRACTAL_DISTANCE
+                color = (view->color == COLOR_DISTANCE) ? calculateColorDistance(trace.distance[lane], x_inc) : color;
+#endif
+#ifdef FRACTAL_ORBIT_TRAP
+                color = (view->color == COLOR_TRAP) ? calculateColorTrap(trace.trap[lane]) : color;
+#endif
+
+                for (bx = px ; (bx < (px + step)) && (bx < px_end) ; bx++)
+                  {
+                    for (by = (py + (lane * step)) ; (by < (py + ((lane + 1) * step))) && (by < py_end) ; by++)
+                      {
+                        fractal_points[bx][by][POINT_COLOR] = color;
+                        fractal_points[bx][by][POINT_ITERATIONS] = trace.iter_count[lane];
+#ifdef FRACTAL_DISTANCE
+                        fractal_points[bx][by][POINT_DISTANCE] = packPointValue(trace.distance[lane]);
+#endif
+#ifdef FRACTAL_ORBIT_TRAP
+                        fractal_points[bx][by][POINT_TRAP] = packPointValue(trace.trap[lane]);
+#endif
+                      }
+                  }
+              }
+          }
+      }
+
+    return;
+  }
+
+/*
+  Function selectPrecision
+   -> Pick the cheapest arithmetic that still resolves one pixel ...
+     -> compare pixel spacing with the rounding error of the largest 
+        magnitude seen in the iteration (bounds or escape radius)
+     -> near the boundary each iteration can double that error, which
+        float has no bits to absorb past a handful of iterations; double
+        keeps up at the usual iteration counts (checked against
+        double-double), so only float pays for the growth
+*/
+int selectPrecision(FractalView *view, double dist_max)
+  {
+    double magnitude,
+           spacing;
+
+    magnitude = dist_max;
+    magnitude = (fabs(view->xmin) > magnitude) ? fabs(view->xmin) : magnitude;
+    magnitude = (fabs(view->xmax) > magnitude) ? fabs(view->xmax) : magnitude;
+    magnitude = (fabs(view->ymin) > magnitude) ? fabs(view->ymin) : magnitude;
+    magnitude = (fabs(view->ymax) > magnitude) ? fabs(view->ymax) : magnitude;
+
+    spacing = (getSpan(view->xmax, view->xmax_lo, view->xmin, view->xmin_lo) / WIDTH);
+    if ((getSpan(view->ymax, view->ymax_lo, view->ymin, view->ymin_lo) / HEIGHT) < spacing)
+      {
+        spacing = (getSpan(view->ymax, view->ymax_lo, view->ymin, view->ymin_lo) / HEIGHT);
+      }
+
+    if (spacing > ldexp((magnitude * FLT_EPSILON), view->iterations))
+      {
+        return (PRECISION_FLOAT);
+      }
+
+    if (spacing > (magnitude * DBL_EPSILON * PRECISION_MARGIN))
+      {
+        return (PRECISION_DOUBLE);
+      }
+
+    /* Good to about 1e-28 of the magnitude, and the widest type available */
+
+    return (PRECISION_DOUBLE_DOUBLE);
+  }
+
+/*
+  Function iterateDouble
+   -> Iterate a group of points until each escapes or <iter_max> is hit ...
+     -> <trace> receives the escape iteration of each lane, plus any
+        optional accumulators (see FractalTrace)
+     -> escaped lanes are parked at the origin so they stay finite
+*/
+void iterateDouble
+ (void (*fractalRoutine)(int, double [], double [], double [], double [], double, double),
+  int lanes, double orig1[], double orig2[], double real, double imag, 
+  double dist_max, int iter_max, FractalTrace *trace)
+  {
+    double xn[LANE_COUNT],
+           yn[LANE_COUNT],
+           dist_sq;
+
+    int    lane,
+           iter,
+           active;
+
+    dist_sq = (dist_max * dist_max);
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        xn[lane] = orig1[lane];
+        yn[lane] = orig2[lane];
+        traceStart(trace, lane, xn[lane], yn[lane]);
+      }
+
+    active = lanes;
+    for (iter = 1 ; (iter <= (iter_max + 1)) && (active > 0) ; iter++)
+      {
+        for (lane = 0 ; lane < lanes ; lane++)
+          {
+            traceStep(trace, lane, xn[lane], yn[lane]);
+          }
+
+        /* Call specified fractal routine */
+        fractalRoutine(lanes, xn, yn, orig1, orig2, real, imag);
+
+        active = 0;
+        for (lane = 0 ; lane < lanes ; lane++)
+          {
+            if ((trace->iter_count[lane] == 0) && (((xn[lane]*xn[lane])+(yn[lane]*yn[lane])) >= dist_sq))
+              {
+                trace->iter_count[lane] = iter;
+                traceEscape(trace, lane, xn[lane], yn[lane]);
+              }
+
+            if (trace->iter_count[lane] != 0)
+              {
+                xn[lane] = 0;
+                yn[lane] = 0;
+              }
+            else
+              {
+                traceOrbit(trace, lane, xn[lane], yn[lane]);
+                active++;
+              }
+          }
+      }
+
+    return;
+  }
+
+/*
+  Function iterateFloat
+   -> Single precision twin of iterateDouble for shallow zooms ...
+*/
+void iterateFloat
+ (void (*fractalRoutine)(int, float [], float [], float [], float [], float, float),
+  int lanes, float orig1[], float orig2[], float real, float imag, 
+  float dist_max, int iter_max, FractalTrace *trace)
+  {
+    float xn[LANE_COUNT],
+          yn[LANE_COUNT],
+          dist_sq;
+
+    int   lane,
+          iter,
+          active;
+
+    dist_sq = (dist_max * dist_max);
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        xn[lane] = orig1[lane];
+        yn[lane] = orig2[lane];
+        traceStart(trace, lane, xn[lane], yn[lane]);
+      }
+
+    active = lanes;
+    for (iter = 1 ; (iter <= (iter_max + 1)) && (active > 0) ; iter++)
+      {
+        for (lane = 0 ; lane < lanes ; lane++)
+          {
+            traceStep(trace, lane, xn[lane], yn[lane]);
+          }
+
+        fractalRoutine(lanes, xn, yn, orig1, orig2, real, imag);
+
+        active = 0;
+        for (lane = 0 ; lane < lanes ; lane++)
+          {
+            if ((trace->iter_count[lane] == 0) && (((xn[lane]*xn[lane])+(yn[lane]*yn[lane])) >= dist_sq))
+              {
+                trace->iter_count[lane] = iter;
+                traceEscape(trace, lane, xn[lane], yn[lane]);
+              }
+
+            if (trace->iter_count[lane] != 0)
+              {
+                xn[lane] = 0;
+                yn[lane] = 0;
+              }
+            else
+              {
+                traceOrbit(trace, lane, xn[lane], yn[lane]);
+                active++;
+              }
+          }
+      }
+
+    return;
+  }
+
+/*
+  Function iterateDoubleDouble
+   -> Double-double twin of iterateDouble for deep zooms ...
+     -> each point is carried as <hi> + <lo> arrays; the escape test only
+        needs the high parts
+*/
+void iterateDoubleDouble
+ (void (*fractalRoutine)(int, double [], double [], double [], double [], 
+                         double [], double [], double [], double [], double, double),
+  int lanes, double orig1[], double orig1_lo[], double orig2[], double orig2_lo[], 
+  double real, double imag, double dist_max, int iter_max, FractalTrace *trace)
+  {
+    double xn[LANE_COUNT],
+           xn_lo[LANE_COUNT],
+           yn[LANE_COUNT],
+           yn_lo[LANE_COUNT],
+           dist_sq;
 
-    getNewBounds(fractal_type, px1, py1, px2, py2, &xmin, &ymin, &xmax, &ymax);
+    int    lane,
+           iter,
+           active;
 
-    /* 
-      Generate fractal color data ...
-        -> store in <fractal_points> array
-    */
+    dist_sq = (dist_max * dist_max);
 
-    iter_count = 0; 
-    dist = 0;
-    xn = xmin;
-    yn = ymax;
-    orig1 = xmin;
-    orig2 = ymax;
-    x_inc = ((xmax-xmin)/WIDTH);   
-    y_inc = ((ymax-ymin)/HEIGHT);
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        xn[lane] = orig1[lane];
+        xn_lo[lane] = orig1_lo[lane];
+        yn[lane] = orig2[lane];
+        yn_lo[lane] = orig2_lo[lane];
+        traceStart(trace, lane, xn[lane], yn[lane]);
+      }
 
-    for (px = 0 ; px < WIDTH ; px++)
+    active = lanes;
+    for (iter = 1 ; (iter <= (iter_max + 1)) && (active > 0) ; iter++)
       {
-        for (py = 0 ; py < HEIGHT ; py++)
+        for (lane = 0 ; lane < lanes ; lane++)
           {
-            while ((iter_count <= ITER_MAX) && (dist < dist_max))
-              {
-                /* Call specified fractal routine */
-                fractalRoutine(xn, yn, &xnew, &ynew, orig1, orig2, real, imag);
+            traceStep(trace, lane, xn[lane], yn[lane]);
+          }
 
-                xn = xnew;
-                yn = ynew;
-                dist = sqrt((xn*xn)+(yn*yn));
-                iter_count++;
+        fractalRoutine(lanes, xn, xn_lo, yn, yn_lo, orig1, orig1_lo, orig2, orig2_lo, real, imag);
+
+        active = 0;
+        for (lane = 0 ; lane < lanes ; lane++)
+          {
+            if ((trace->iter_count[lane] == 0) && (((xn[lane]*xn[lane])+(yn[lane]*yn[lane])) >= dist_sq))
+              {
+                trace->iter_count[lane] = iter;
+                traceEscape(trace, lane, xn[lane], yn[lane]);
               }
 
-            if (dist < dist_max)
+            if (trace->iter_count[lane] != 0)
               {
-                /* Set these points to black */
-                index_r = 0;
-                index_g = 0;
-                index_b = 0;
+                xn[lane] = 0;
+                xn_lo[lane] = 0;
+                yn[lane] = 0;
+                yn_lo[lane] = 0;
               }
             else
               {
-                /* Set these points to some iterated value */
-                index_r = iter_count;
-                index_g = iter_count;
-                index_b = iter_count;
+                traceOrbit(trace, lane, xn[lane], yn[lane]);
+                active++;
               }
+          }
+      }
 
-            /* 
-              Build a 24-bit long unsigned value from the color triplets ...
-                -> required by a TrueColor visual type to render color!
-            */
-            fractal_points[px][py][0] = fractalColorRoutine(index_r, index_g, index_b);
+    return;
+  }
 
-            iter_count = 0; 
-            dist = 0;
-            xn = orig1;
-            orig2 = (orig2 - y_inc);
-            yn = orig2;
-          }
+/*
+  Functions traceStart, traceStep, traceEscape, traceOrbit
+   -> Optional accumulators of the iterate functions, one lane at a time ...
+     -> start: reset the lane at its starting point
+     -> step: advance the derivative, called before z itself is advanced
+     -> escape: finish the lane once it escapes
+     -> orbit: record a point of the orbit that has not escaped
+     -> each body is empty unless its accumulator is compiled in, so the
+        calls (and their lane loops) vanish when the features are off
+*/
+static inline void traceStart(FractalTrace *trace, int lane, double x, double y)
+  {
+    trace->iter_count[lane] = 0;
 
-        yn = ymax;
-        orig2 = ymax;
-        orig1 = (orig1 + x_inc);
-        xn = orig1;
-      }
+#ifdef FRACTAL_DISTANCE
+    trace->dx[lane] = 1.0;
+    trace->dy[lane] = 0.0;
+    trace->distance[lane] = 0.0;
+#endif
+#ifdef FRACTAL_ORBIT_TRAP
+    trace->trap[lane] = (fabs(x) < fabs(y)) ? fabs(x) : fabs(y);
+#endif
+
+    return;
+  }
+
+static inline void traceStep(FractalTrace *trace, int lane, double x, double y)
+  {
+#ifdef FRACTAL_DISTANCE
+    double f_re,
+           f_im,
+           dx;
+
+    /* f'(z) = (a * z) + b, then dz = (f'(z) * dz) + c */
+
+    f_re = ((trace->deriv_a_re * x) - (trace->deriv_a_im * y) + trace->deriv_b_re);
+    f_im = ((trace->deriv_a_re * y) + (trace->deriv_a_im * x) + trace->deriv_b_im);
+
+    dx = trace->dx[lane];
+    trace->dx[lane] = ((f_re * dx) - (f_im * trace->dy[lane]) + trace->deriv_c);
+    trace->dy[lane] = ((f_re * trace->dy[lane]) + (f_im * dx));
+#endif
 
     return;
   }
 
+static inline void traceEscape(FractalTrace *trace, int lane, double x, double y)
+  {
+#ifdef FRACTAL_DISTANCE
+    double z_abs,
+           dz_abs;
+
+    z_abs = sqrt((x * x) + (y * y));
+    dz_abs = sqrt((trace->dx[lane] * trace->dx[lane]) + (trace->dy[lane] * trace->dy[lane]));
+
+    trace->distance[lane] = (dz_abs > 0) ? ((0.5 * z_abs * log(z_abs)) / dz_abs) : 0.0;
+#endif
+
+    return;
+  }
+
+static inline void traceOrbit(FractalTrace *trace, int lane, double x, double y)
+  {
+#ifdef FRACTAL_ORBIT_TRAP
+    trace->trap[lane] = (fabs(x) < trace->trap[lane]) ? fabs(x) : trace->trap[lane];
+    trace->trap[lane] = (fabs(y) < trace->trap[lane]) ? fabs(y) : trace->trap[lane];
+#endif
+
+    return;
+  }
+
+/*
+  Function packPointValue
+   -> Store a real value in an optional channel of a frame pixel ...
+     -> kept as the bits of a float, which fit any unsigned long
+*/
+unsigned long packPointValue(double value)
+  {
+    union
+      {
+        float        value;
+        unsigned int bits;
+      } point;
+
+    point.value = (float)value;
+
+    return (point.bits);
+  }
+
+/*
+  Function unpackPointValue
+   -> Read back a real value stored by packPointValue
+*/
+double unpackPointValue(unsigned long bits)
+  {
+    union
+      {
+        float        value;
+        unsigned int bits;
+      } point;
+
+    point.bits = (unsigned int)bits;
+
+    return (point.value);
+  }
+
 /*
   Function drawFractal
    -> Draw fractal into a given window ...
+     -> pixels are packed into the window's client-side <image> and sent
+        in one request, fast enough to redraw at the smooth zoom frame rate
 */
-void drawFractal(Display *display, Window *window, GC *gc, unsigned long fractal_points[][HEIGHT][1])
+void drawFractal
+ (Display *display, Window *window, GC *gc, XImage *image, 
+  unsigned long fractal_points[][HEIGHT][POINT_DEPTH])
   {
     int x, y;
 
@@ -223,16 +1244,16 @@ void drawFractal(Display *display, Window *window, GC *gc, unsigned long fractal
       {
         for (y = 0 ; y < HEIGHT ; y++)
           {
-            /* Set foreground color to <fractal_points> value */
+            /* Set image pixel to <fractal_points> value */
 
-            XSetForeground(display, *gc, fractal_points[x][y][0]);
-
-            /* Color pixel at the specified (x,y) coordinate in window */
-
-            XDrawPoint(display, *window, *gc, x, y);
+            XPutPixel(image, x, y, fractal_points[x][y][POINT_COLOR]);
           }
       }
 
+    /* Copy the whole image into the window */
+
+    XPutImage(display, *window, *gc, image, 0, 0, 0, 0, WIDTH, HEIGHT);
+
     /* Force processing of all directives in X buffer ...*/
 
     XFlush(display);
@@ -245,8 +1266,7 @@ void drawFractal(Display *display, Window *window, GC *gc, unsigned long fractal
    -> Determine fractal bounds based on user input ...
 */
 void getNewBounds
- (int type, int px1, int py1, int px2, int py2, 
-  double *xmin, double *ymin, double *xmax, double *ymax)
+ (FractalView *view, int px1, int py1, int px2, int py2)
   {
     int px_min,
         px_max,
@@ -256,30 +1276,42 @@ void getNewBounds
     double x_diff,
            y_diff;
 
-    /* If first value is -1 (i.e. first viewing), use the defaults */
+    /* If first value is -1 (i.e. first viewing), use the default bounds and constants */
 
     if (px1 == -1)
       {
-        if (type == 1)
+        view->iterations = ITER_MAX;
+        view->xmin_lo = 0.0;
+        view->xmax_lo = 0.0;
+        view->ymin_lo = 0.0;
+        view->ymax_lo = 0.0;
+
+        if (view->type == 1)
           {
-            *xmin = -2.5;
-            *xmax = 1.5;
-            *ymin = -1.5;
-            *ymax = 1.5;
+            view->real = 0.0;
+            view->imag = 0.0;
+            view->xmin = -2.5;
+            view->xmax = 1.5;
+            view->ymin = -1.5;
+            view->ymax = 1.5;
           }
-        else if (type == 2)
+        else if (view->type == 2)
           {
-            *xmin = -0.241001;
-            *xmax = 0.222222;
-            *ymin = 0.413542;
-            *ymax = 0.760960;
+            view->real = 0.3;
+            view->imag = 0.6;
+            view->xmin = -0.241001;
+            view->xmax = 0.222222;
+            view->ymin = 0.413542;
+            view->ymax = 0.760960;
           }
         else
           {
-            *xmin = -1.5;
-            *xmax = 2.5;
-            *ymin = -1.5;
-            *ymax = 1.5;
+            view->real = 0.85;
+            view->imag = 0.6;
+            view->xmin = -1.5;
+            view->xmax = 2.5;
+            view->ymin = -1.5;
+            view->ymax = 1.5;
           }
       }
     else if ((px1 != px2) && (py1 != py2))
@@ -311,13 +1343,18 @@ void getNewBounds
             py_max = py1;
           }
 
-        x_diff = (((*xmax) - (*xmin)) / WIDTH);
-        y_diff = (((*ymax) - (*ymin)) / HEIGHT);
+        x_diff = (getSpan(view->xmax, view->xmax_lo, view->xmin, view->xmin_lo) / WIDTH);
+        y_diff = (getSpan(view->ymax, view->ymax_lo, view->ymin, view->ymin_lo) / HEIGHT);
+
+        view->xmax = view->xmin;
+        view->xmax_lo = view->xmin_lo;
+        view->ymin = view->ymax;
+        view->ymin_lo = view->ymax_lo;
 
-        *xmax = ((*xmin) + (px_max * x_diff));
-        *xmin = ((*xmin) + (px_min * x_diff));
-        *ymin = ((*ymax) - (py_max * y_diff));
-        *ymax = ((*ymax) - (py_min * y_diff));
+        addToBound(&view->xmax, &view->xmax_lo, (px_max * x_diff));
+        addToBound(&view->xmin, &view->xmin_lo, (px_min * x_diff));
+        addToBound(&view->ymin, &view->ymin_lo, -(py_max * y_diff));
+        addToBound(&view->ymax, &view->ymax_lo, -(py_min * y_diff));
       }
     else if ((px1 == px2) || (py1 == py2))
       {
@@ -327,46 +1364,413 @@ void getNewBounds
             -> no zooming perfomed!
         */
 
-        x_diff = (((*xmax) - (*xmin)) / WIDTH);
-        y_diff = (((*ymax) - (*ymin)) / HEIGHT);
+        x_diff = (getSpan(view->xmax, view->xmax_lo, view->xmin, view->xmin_lo) / WIDTH);
+        y_diff = (getSpan(view->ymax, view->ymax_lo, view->ymin, view->ymin_lo) / HEIGHT);
 
-        *xmax = (((*xmin) + (px1 * x_diff)) + ((WIDTH / 2) * x_diff));
-        *xmin = (((*xmin) + (px1 * x_diff)) - ((WIDTH / 2) * x_diff));
-        *ymin = (((*ymax) - (py1 * y_diff)) - ((HEIGHT / 2) * y_diff));
-        *ymax = (((*ymax) - (py1 * y_diff)) + ((HEIGHT / 2) * y_diff));
+        view->xmax = view->xmin;
+        view->xmax_lo = view->xmin_lo;
+        view->ymin = view->ymax;
+        view->ymin_lo = view->ymax_lo;
+
+        addToBound(&view->xmax, &view->xmax_lo, ((px1 + (WIDTH / 2)) * x_diff));
+        addToBound(&view->xmin, &view->xmin_lo, ((px1 - (WIDTH / 2)) * x_diff));
+        addToBound(&view->ymin, &view->ymin_lo, -((py1 + (HEIGHT / 2)) * y_diff));
+        addToBound(&view->ymax, &view->ymax_lo, -((py1 - (HEIGHT / 2)) * y_diff));
       }
 
     return;
   }
 
-/* Algorithms for various fractal types ... */
+/*
+  Function zoomOutBounds
+   -> Double the extent of a view about its center ...
+*/
+void zoomOutBounds(FractalView *view)
+  {
+    double x_diff,
+           y_diff;
+
+    x_diff = (getSpan(view->xmax, view->xmax_lo, view->xmin, view->xmin_lo) / 2);
+    y_diff = (getSpan(view->ymax, view->ymax_lo, view->ymin, view->ymin_lo) / 2);
+
+    addToBound(&view->xmin, &view->xmin_lo, -x_diff);
+    addToBound(&view->xmax, &view->xmax_lo, x_diff);
+    addToBound(&view->ymin, &view->ymin_lo, -y_diff);
+    addToBound(&view->ymax, &view->ymax_lo, y_diff);
+
+    return;
+  }
+
+/*
+  Function getPoint
+   -> Return the complex value under pixel (<px>, <py>) of a view ...
+*/
+void getPoint(FractalView *view, int px, int py, double *x, double *y)
+  {
+    *x = (view->xmin + (view->xmin_lo + 
+          (px * (getSpan(view->xmax, view->xmax_lo, view->xmin, view->xmin_lo) / WIDTH))));
+    *y = (view->ymax + (view->ymax_lo - 
+          (py * (getSpan(view->ymax, view->ymax_lo, view->ymin, view->ymin_lo) / HEIGHT))));
+
+    return;
+  }
+
+/*
+  Function panBounds
+   -> Shift a view by whole half-views ...
+     -> positive <x_steps> move right, positive <y_steps> move up
+*/
+void panBounds(FractalView *view, int x_steps, int y_steps)
+  {
+    double x_diff,
+           y_diff;
+
+    x_diff = (x_steps * (getSpan(view->xmax, view->xmax_lo, view->xmin, view->xmin_lo) / 2));
+    y_diff = (y_steps * (getSpan(view->ymax, view->ymax_lo, view->ymin, view->ymin_lo) / 2));
+
+    addToBound(&view->xmin, &view->xmin_lo, x_diff);
+    addToBound(&view->xmax, &view->xmax_lo, x_diff);
+    addToBound(&view->ymin, &view->ymin_lo, y_diff);
+    addToBound(&view->ymax, &view->ymax_lo, y_diff);
+
+    return;
+  }
+
+/*
+  Function zoomBounds
+   -> Scale a view by <factor> while keeping pixel (<px>, <py>) fixed ...
+     -> factor below 1 zooms in, above 1 zooms out
+*/
+void zoomBounds(FractalView *view, int px, int py, double factor)
+  {
+    double x_inc,
+           y_inc;
+
+    x_inc = (getSpan(view->xmax, view->xmax_lo, view->xmin, view->xmin_lo) / WIDTH);
+    y_inc = (getSpan(view->ymax, view->ymax_lo, view->ymin, view->ymin_lo) / HEIGHT);
+
+    /* Move each edge to (fixed point +/- scaled distance to the edge) */
+
+    view->xmax = view->xmin;
+    view->xmax_lo = view->xmin_lo;
+    view->ymin = view->ymax;
+    view->ymin_lo = view->ymax_lo;
+
+    addToBound(&view->xmin, &view->xmin_lo, ((px * x_inc) - (px * x_inc * factor)));
+    addToBound(&view->xmax, &view->xmax_lo, ((px * x_inc) + ((WIDTH - px) * x_inc * factor)));
+    addToBound(&view->ymin, &view->ymin_lo, -((py * y_inc) + ((HEIGHT - py) * y_inc * factor)));
+    addToBound(&view->ymax, &view->ymax_lo, -((py * y_inc) - (py * y_inc * factor)));
+
+    return;
+  }
+
+/*
+  Function getSpan
+   -> Return (<hi1> + <lo1>) - (<hi2> + <lo2>) rounded to a double ...
+     -> keeps full accuracy when the two bounds agree in most of their
+        digits, as they do at double-double zoom depths
+*/
+double getSpan(double hi1, double lo1, double hi2, double lo2)
+  {
+    double hi,
+           lo;
+
+    ddAdd(hi1, lo1, -hi2, -lo2, &hi, &lo);
+
+    return (hi + lo);
+  }
+
+/*
+  Function addToBound
+   -> Add <offset> to the double-double bound <hi> + <lo> ...
+*/
+void addToBound(double *hi, double *lo, double offset)
+  {
+    ddAdd(*hi, *lo, offset, 0, hi, lo);
+
+    return;
+  }
+
+/* 
+  Algorithms for various fractal types ...
+    -> each call advances <lanes> points by one iteration, in place
+*/
 
 void calculateMandelbrot
-(double xn, double yn, double *xnew, double *ynew, 
- double orig1, double orig2, double real, double imag)
+(int lanes, double xn[], double yn[], 
+ double orig1[], double orig2[], double real, double imag)
   {
-    *xnew = ((xn*xn) - (yn*yn) + orig1);
-    *ynew = (2 * xn * yn + orig2); 
+    int    lane;
+    double xnew;
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        xnew = ((xn[lane]*xn[lane]) - (yn[lane]*yn[lane]) + orig1[lane]);
+        yn[lane] = (2 * xn[lane] * yn[lane] + orig2[lane]); 
+        xn[lane] = xnew;
+      }
 
     return;
   }
 
 void calculateJulia
-(double xn, double yn, double *xnew, double *ynew, 
- double orig1, double orig2, double real, double imag)
+(int lanes, double xn[], double yn[], 
+ double orig1[], double orig2[], double real, double imag)
   { 
-    *xnew = ((xn*xn) - (yn*yn) + real);
-    *ynew = (2 * xn * yn + imag);
+    int    lane;
+    double xnew;
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        xnew = ((xn[lane]*xn[lane]) - (yn[lane]*yn[lane]) + real);
+        yn[lane] = (2 * xn[lane] * yn[lane] + imag);
+        xn[lane] = xnew;
+      }
 
     return;
   }
 
 void calculateSpiral
-(double xn, double yn, double *xnew, double *ynew, 
- double orig1, double orig2, double real, double imag)
+(int lanes, double xn[], double yn[], 
+ double orig1[], double orig2[], double real, double imag)
   {
-    *xnew = ((real * xn) - (real * xn * xn) + (real * yn * yn) - (imag * yn) + (2 * imag * xn * yn));
-    *ynew = ((real * yn) + (imag * xn) - (imag * xn * xn) + (imag * yn * yn) - (2 * real * xn * yn));
+    int    lane;
+    double x,
+           y;
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        x = xn[lane];
+        y = yn[lane];
+        xn[lane] = ((real * x) - (real * x * x) + (real * y * y) - (imag * y) + (2 * imag * x * y));
+        yn[lane] = ((real * y) + (imag * x) - (imag * x * x) + (imag * y * y) - (2 * real * x * y));
+      }
+
+    return;
+  }
+
+/* Single precision twins of the algorithms above ... */
+
+void calculateMandelbrotFloat
+(int lanes, float xn[], float yn[], 
+ float orig1[], float orig2[], float real, float imag)
+  {
+    int   lane;
+    float xnew;
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        xnew = ((xn[lane]*xn[lane]) - (yn[lane]*yn[lane]) + orig1[lane]);
+        yn[lane] = (2 * xn[lane] * yn[lane] + orig2[lane]); 
+        xn[lane] = xnew;
+      }
+
+    return;
+  }
+
+void calculateJuliaFloat
+(int lanes, float xn[], float yn[], 
+ float orig1[], float orig2[], float real, float imag)
+  { 
+    int   lane;
+    float xnew;
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        xnew = ((xn[lane]*xn[lane]) - (yn[lane]*yn[lane]) + real);
+        yn[lane] = (2 * xn[lane] * yn[lane] + imag);
+        xn[lane] = xnew;
+      }
+
+    return;
+  }
+
+void calculateSpiralFloat
+(int lanes, float xn[], float yn[], 
+ float orig1[], float orig2[], float real, float imag)
+  {
+    int   lane;
+    float x,
+          y;
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        x = xn[lane];
+        y = yn[lane];
+        xn[lane] = ((real * x) - (real * x * x) + (real * y * y) - (imag * y) + (2 * imag * x * y));
+        yn[lane] = ((real * y) + (imag * x) - (imag * x * x) + (imag * y * y) - (2 * real * x * y));
+      }
+
+    return;
+  }
+
+/* Double-double twins of the algorithms above ... */
+
+void calculateMandelbrotDD
+(int lanes, double xn[restrict], double xn_lo[restrict], double yn[restrict], double yn_lo[restrict], 
+ double orig1[restrict], double orig1_lo[restrict], double orig2[restrict], double orig2_lo[restrict], 
+ double real, double imag)
+  {
+    /* 
+      Lanes are read into locals and the arrays never overlap (restrict),
+      otherwise the eight arrays need more runtime alias checks than the
+      vectoriser will emit and the loop stays scalar
+    */
+
+    int    lane;
+    double x, x_lo, y, y_lo, xx, xx_lo, yy, yy_lo, xy, xy_lo, t, t_lo;
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        x = xn[lane];
+        x_lo = xn_lo[lane];
+        y = yn[lane];
+        y_lo = yn_lo[lane];
+
+        ddMul(x, x_lo, x, x_lo, &xx, &xx_lo);
+        ddMul(y, y_lo, y, y_lo, &yy, &yy_lo);
+        ddMul(x, x_lo, y, y_lo, &xy, &xy_lo);
+
+        ddAdd(xx, xx_lo, -yy, -yy_lo, &t, &t_lo);
+        ddAdd(t, t_lo, orig1[lane], orig1_lo[lane], &xn[lane], &xn_lo[lane]);
+        ddAdd((2 * xy), (2 * xy_lo), orig2[lane], orig2_lo[lane], &yn[lane], &yn_lo[lane]);
+      }
+
+    return;
+  }
+
+void calculateJuliaDD
+(int lanes, double xn[], double xn_lo[], double yn[], double yn_lo[], 
+ double orig1[], double orig1_lo[], double orig2[], double orig2_lo[], double real, double imag)
+  {
+    int    lane;
+    double xx, xx_lo, yy, yy_lo, xy, xy_lo, t, t_lo;
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        ddMul(xn[lane], xn_lo[lane], xn[lane], xn_lo[lane], &xx, &xx_lo);
+        ddMul(yn[lane], yn_lo[lane], yn[lane], yn_lo[lane], &yy, &yy_lo);
+        ddMul(xn[lane], xn_lo[lane], yn[lane], yn_lo[lane], &xy, &xy_lo);
+
+        ddAdd(xx, xx_lo, -yy, -yy_lo, &t, &t_lo);
+        ddAdd(t, t_lo, real, 0, &xn[lane], &xn_lo[lane]);
+        ddAdd((2 * xy), (2 * xy_lo), imag, 0, &yn[lane], &yn_lo[lane]);
+      }
+
+    return;
+  }
+
+void calculateSpiralDD
+(int lanes, double xn[], double xn_lo[], double yn[], double yn_lo[], 
+ double orig1[], double orig1_lo[], double orig2[], double orig2_lo[], double real, double imag)
+  {
+    /* 
+      Same map as calculateSpiral, grouped to save multiplies ...
+        -> a = x - x^2 + y^2, b = 2xy - y
+        -> x' = real*a + imag*b, y' = imag*a - real*b
+    */
+
+    int    lane;
+    double xx, xx_lo, yy, yy_lo, xy, xy_lo, a, a_lo, b, b_lo, t, t_lo, u, u_lo;
+
+    for (lane = 0 ; lane < lanes ; lane++)
+      {
+        ddMul(xn[lane], xn_lo[lane], xn[lane], xn_lo[lane], &xx, &xx_lo);
+        ddMul(yn[lane], yn_lo[lane], yn[lane], yn_lo[lane], &yy, &yy_lo);
+        ddMul(xn[lane], xn_lo[lane], yn[lane], yn_lo[lane], &xy, &xy_lo);
+
+        ddAdd(xn[lane], xn_lo[lane], -xx, -xx_lo, &t, &t_lo);
+        ddAdd(t, t_lo, yy, yy_lo, &a, &a_lo);
+        ddAdd((2 * xy), (2 * xy_lo), -yn[lane], -yn_lo[lane], &b, &b_lo);
+
+        ddMulD(a, a_lo, real, &t, &t_lo);
+        ddMulD(b, b_lo, imag, &u, &u_lo);
+        ddAdd(t, t_lo, u, u_lo, &xn[lane], &xn_lo[lane]);
+
+        ddMulD(a, a_lo, imag, &t, &t_lo);
+        ddMulD(b, b_lo, -real, &u, &u_lo);
+        ddAdd(t, t_lo, u, u_lo, &yn[lane], &yn_lo[lane]);
+      }
+
+    return;
+  }
+
+/* 
+  Double-double arithmetic helpers ...
+    -> error-free transforms (Knuth two-sum, Dekker split/product), so 
+       they need strict IEEE evaluation: no FMA contraction
+*/
+
+static inline void ddTwoSum(double a, double b, double *sum, double *err)
+  {
+    double bb;
+
+    *sum = (a + b);
+    bb = (*sum - a);
+    *err = ((a - (*sum - bb)) + (b - bb));
+
+    return;
+  }
+
+static inline void ddQuickTwoSum(double a, double b, double *sum, double *err)
+  {
+    *sum = (a + b);
+    *err = (b - (*sum - a));
+
+    return;
+  }
+
+static inline void ddTwoProd(double a, double b, double *prod, double *err)
+  {
+    double t, a_hi, a_lo, b_hi, b_lo;
+
+    t = (DD_SPLITTER * a);
+    a_hi = (t - (t - a));
+    a_lo = (a - a_hi);
+    t = (DD_SPLITTER * b);
+    b_hi = (t - (t - b));
+    b_lo = (b - b_hi);
+
+    *prod = (a * b);
+    *err = ((((a_hi * b_hi) - *prod) + (a_hi * b_lo) + (a_lo * b_hi)) + (a_lo * b_lo));
+
+    return;
+  }
+
+static inline void ddAdd
+(double a, double a_lo, double b, double b_lo, double *sum, double *sum_lo)
+  {
+    double s, e, t, f;
+
+    ddTwoSum(a, b, &s, &e);
+    ddTwoSum(a_lo, b_lo, &t, &f);
+    e += t;
+    ddQuickTwoSum(s, e, &s, &e);
+    e += f;
+    ddQuickTwoSum(s, e, sum, sum_lo);
+
+    return;
+  }
+
+static inline void ddMul
+(double a, double a_lo, double b, double b_lo, double *prod, double *prod_lo)
+  {
+    double p, e;
+
+    ddTwoProd(a, b, &p, &e);
+    e += ((a * b_lo) + (a_lo * b));
+    ddQuickTwoSum(p, e, prod, prod_lo);
+
+    return;
+  }
+
+static inline void ddMulD(double a, double a_lo, double b, double *prod, double *prod_lo)
+  {
+    double p, e;
+
+    ddTwoProd(a, b, &p, &e);
+    e += (a_lo * b);
+    ddQuickTwoSum(p, e, prod, prod_lo);
 
     return;
   }
@@ -418,3 +1822,65 @@ unsigned long calculateColorBlueGreenBanded
   {
     return ((65000 * (0.01 * index_red)) + (65000 * (0.01 * index_green)) + (65000 * (0.01 * index_blue)));
   }
+
+/*
+  Function calculateColorDistance
+   -> Shade a point by its distance estimate, in pixels of <spacing> ...
+     -> boundary filaments come out as dark lines on white, and points
+        that never escaped stay black
+*/
+unsigned long calculateColorDistance(double distance, double spacing)
+  {
+    double shade;
+
+    shade = (distance / (2 * spacing));
+    shade = (shade > 1.0) ? 1.0 : shade;
+
+    return ((unsigned long)(255 * sqrt(shade)) * 0x010101);
+  }
+
+/*
+  Function calculateColorTrap
+   -> Shade a point by how close its orbit came to the axes ...
+     -> gold stalks where the orbit passes through the trap
+*/
+unsigned long calculateColorTrap(double trap)
+  {
+    int shade;
+
+    shade = (int)(255 * exp(-16 * trap));
+
+    return ((shade << 16) + (((shade * 3) / 4) << 8) + (shade / 4));
+  }
+
+/*
+  Function calculateColorEqualized
+   -> Shade a point by its share of the escaped points <level> (0 to 1) ...
+     -> navy through blue and white to orange, so every color is used
+        equally often whatever the zoom depth
+*/
+unsigned long calculateColorEqualized(double level)
+  {
+    /* Gradient stops, as red/green/blue triplets */
+
+    static const int stops[4][3] = {{0, 7, 100}, {32, 107, 203}, {237, 255, 255}, {255, 170, 0}};
+
+    int    stop,
+           red,
+           green,
+           blue;
+    double mix;
+
+    /* Clamp, written so that a NaN level becomes 0 too */
+
+    level = (level > 0.0) ? ((level < 1.0) ? level : 1.0) : 0.0;
+    stop = (int)(level * 3);
+    stop = (stop < 0) ? 0 : ((stop > 2) ? 2 : stop);
+    mix = ((level * 3) - stop);
+
+    red = (int)(stops[stop][0] + (mix * (stops[stop + 1][0] - stops[stop][0])));
+    green = (int)(stops[stop][1] + (mix * (stops[stop + 1][1] - stops[stop][1])));
+    blue = (int)(stops[stop][2] + (mix * (stops[stop + 1][2] - stops[stop][2])));
+
+    return ((red << 16) + (green << 8) + blue);
+  }
@@ -0,0 +1,152 @@
+/*
+ * history.c: X-Fractals / bounded undo/redo stack of views and their rendered frames
+ *
+ * Authored by Parmjit Virk (2017)
+ *
+ * Licensed under the MIT license as per the Open Source Initiative 2017.
+ * See the LICENSE file for the complete license information,
+ * or visit https://opensource.org/licenses/MIT for details.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+#include "Xfractals.h"
+
+/* Define local function prototypes ... */
+int getHistorySlot(FractalHistory *, int);
+
+/*
+  Function createHistory
+    -> Allocate an empty history with room for HISTORY_MAX frames
+*/
+void createHistory(FractalHistory *history)
+  {
+    int slot;
+
+    for (slot = 0 ; slot < HISTORY_MAX ; slot++)
+      {
+        history->frames[slot] = malloc(sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+        if (history->frames[slot] == NULL)
+          {
+            /* Can't cache any frames, so notify and quit ... */
+
+            printf("Could not allocate view history.\n");
+            exit(1);
+          }
+      }
+
+    history->first = 0;
+    history->count = 0;
+    history->current = -1;
+
+    return;
+  }
+
+/*
+  Function freeHistory
+    -> Release all cached frames
+*/
+void freeHistory(FractalHistory *history)
+  {
+    int slot;
+
+    for (slot = 0 ; slot < HISTORY_MAX ; slot++)
+      {
+        free(history->frames[slot]);
+        history->frames[slot] = NULL;
+      }
+
+    history->count = 0;
+    history->current = -1;
+
+    return;
+  }
+
+/*
+  Function pushHistory
+    -> Record a newly rendered view after the current one ...
+      -> any views that could have been redone are discarded
+      -> the oldest view is dropped once the ring is full
+*/
+void pushHistory
+ (FractalHistory *history, FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH])
+  {
+    int slot;
+
+    history->count = (history->current + 1);
+
+    if (history->count == HISTORY_MAX)
+      {
+        history->first = ((history->first + 1) % HISTORY_MAX);
+        history->count--;
+      }
+
+    slot = getHistorySlot(history, history->count);
+    history->views[slot] = *view;
+    memcpy(history->frames[slot], fractal_points, sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+
+    history->current = history->count;
+    history->count++;
+
+    return;
+  }
+
+/*
+  Function undoHistory
+    -> Step back one view, restoring its cached frame ...
+      -> returns 0 if already at the oldest view
+*/
+int undoHistory
+ (FractalHistory *history, FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH])
+  {
+    int slot;
+
+    if (history->current <= 0)
+      {
+        return (0);
+      }
+
+    history->current--;
+
+    slot = getHistorySlot(history, history->current);
+    *view = history->views[slot];
+    memcpy(fractal_points, history->frames[slot], sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+
+    return (1);
+  }
+
+/*
+  Function redoHistory
+    -> Step forward one view, restoring its cached frame ...
+      -> returns 0 if already at the newest view
+*/
+int redoHistory
+ (FractalHistory *history, FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH])
+  {
+    int slot;
+
+    if (history->current >= (history->count - 1))
+      {
+        return (0);
+      }
+
+    history->current++;
+
+    slot = getHistorySlot(history, history->current);
+    *view = history->views[slot];
+    memcpy(fractal_points, history->frames[slot], sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+
+    return (1);
+  }
+
+/*
+  Function getHistorySlot
+    -> Map a position in the history (0 = oldest) to a ring slot
+*/
+int getHistorySlot(FractalHistory *history, int position)
+  {
+    return ((history->first + position) % HISTORY_MAX);
+  }
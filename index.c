@@ -25,15 +25,39 @@ int main(void)
 
     Display *display;
     int     screen;
-    Window  window;
-    GC      gc;
+    Window  window,
+            julia_window;
+    GC      gc,
+            julia_gc;
+    XImage  *image,
+            *julia_image;
     char    *title;
 
     /* <fractal_points[][]>, holds pixel color info for each point */
+    /* <view>, fractal choice and region shown in the window */
 
     int           fractal_type;
     int           fractal_color;
-    unsigned long fractal_points[WIDTH][HEIGHT][1];
+    unsigned long (*fractal_points)[HEIGHT][POINT_DEPTH];
+    FractalView   view;
+
+    /* <julia_points[][]>/<julia_view>, second window of the explorer */
+
+    unsigned long (*julia_points)[HEIGHT][POINT_DEPTH];
+    FractalView   julia_view;
+
+    /* <arena>, frame memory placed by the render threads */
+
+    FractalArena  arena;
+
+    /* 
+      Reserve frame memory for both windows ...
+        -> left untouched so the render threads place it (first-touch)
+    */
+
+    createArena(&arena, 2 * sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+    fractal_points = arena.base;
+    julia_points = (fractal_points + WIDTH);
 
     /* Get display and screen values */
 
@@ -43,7 +67,8 @@ int main(void)
     printf("\nFractal Type?\n");
     printf("1) Mandelbrot\n");
     printf("2) Julia\n");
-    printf("3) Spiral\n\n");
+    printf("3) Spiral\n");
+    printf("4) Mandelbrot / Julia Explorer\n\n");
     printf("Enter the number of your choice: ");
     scanf("\n%d", &fractal_type);
 
@@ -55,11 +80,49 @@ int main(void)
     printf("5) Red - Dark\n");
     printf("6) Green - Light\n");
     printf("7) Green - Banded\n");
-    printf("8) BlueGreen - Banded\n\n");
+    printf("8) BlueGreen - Banded\n");
+#ifdef FRACTAL_DISTANCE
+    printf("9) Distance Estimate\n");
+#endif
+#ifdef FRACTAL_ORBIT_TRAP
+    printf("10) Orbit Trap\n");
+#endif
+    printf("11) Equalized\n");
+    printf("\n");
     printf("Enter the number of your choice: ");
     scanf("\n%d", &fractal_color);
 
-    if (fractal_type != 0)
+    if (fractal_type == 4)
+      {
+        /* 
+          Explorer: Mandelbrot window picks the constant of a Julia window
+            -> Julia view covers the whole set, as any constant may be picked
+        */
+
+        view.type = 1;
+        view.color = fractal_color;
+        createFractal(&view, fractal_points, -1, 0, 0, 0);
+
+        julia_view.type = 2;
+        julia_view.color = fractal_color;
+        getNewBounds(&julia_view, -1, 0, 0, 0);
+        julia_view.xmin = -2.0;
+        julia_view.xmax = 2.0;
+        julia_view.ymin = -2.0;
+        julia_view.ymax = 2.0;
+        renderFractal(&julia_view, julia_points);
+
+        createWindow(display, screen, &window, "Mandelbrot");
+        createGC(display, &window, &gc);
+        createImage(display, screen, &image);
+        createWindow(display, screen, &julia_window, "Julia");
+        createGC(display, &julia_window, &julia_gc);
+        createImage(display, screen, &julia_image);
+
+        showExplorer(display, screen, &window, &gc, &image, fractal_points, &view,
+                     &julia_window, &julia_gc, &julia_image, julia_points, &julia_view);
+      }
+    else if (fractal_type != 0)
       {
         /*  Set window title ... */
         if (fractal_type == 1)
@@ -78,16 +141,19 @@ int main(void)
 
         /* Populate color array with appropriate fractal data ... */
 
-        createFractal(fractal_type, fractal_color, fractal_points, -1, 0, 0, 0);
+        view.type = fractal_type;
+        view.color = fractal_color;
+        createFractal(&view, fractal_points, -1, 0, 0, 0);
 
-        /* Create new window and graphics context to be used ... */
+        /* Create new window, graphics context and image to be used ... */
 
         createWindow(display, screen, &window, title);
         createGC(display, &window, &gc);
+        createImage(display, screen, &image);
 
         /* Show new window on screen and wait for user input ... */
 
-        showWindow(display, screen, &window, &gc, fractal_points, fractal_type, fractal_color);
+        showWindow(display, screen, &window, &gc, &image, fractal_points, &view);
       }
 
     printf("\n*** End Of Processing *** \n\n"); 
@@ -95,5 +161,6 @@ int main(void)
     /* Close display and exit program ... */
 
     closeDisplay(display);
+    freeArena(&arena);
     return (0);
   }
@@ -0,0 +1,234 @@
+/*
+ * prefetch.c: X-Fractals / speculative rendering of likely next views while idle
+ *
+ * Authored by Parmjit Virk (2017)
+ *
+ * Licensed under the MIT license as per the Open Source Initiative 2017.
+ * See the LICENSE file for the complete license information,
+ * or visit https://opensource.org/licenses/MIT for details.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+#include "Xfractals.h"
+
+/* Define local function prototypes ... */
+int matchView(FractalView *, FractalView *);
+
+/*
+  Function createPrefetch
+    -> Allocate an empty cache with one frame per candidate slot
+*/
+void createPrefetch(FractalPrefetch *prefetch)
+  {
+    int slot;
+
+    for (slot = 0 ; slot < PREFETCH_MAX ; slot++)
+      {
+        prefetch->frames[slot] = malloc(sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+        if (prefetch->frames[slot] == NULL)
+          {
+            /* Can't cache any frames, so notify and quit ... */
+
+            printf("Could not allocate prefetch cache.\n");
+            exit(1);
+          }
+
+        prefetch->used[slot] = 0;
+        prefetch->ready[slot] = 0;
+      }
+
+    prefetch->pending = -1;
+    prefetch->column = 0;
+
+    return;
+  }
+
+/*
+  Function freePrefetch
+    -> Release all speculative frames
+*/
+void freePrefetch(FractalPrefetch *prefetch)
+  {
+    int slot;
+
+    for (slot = 0 ; slot < PREFETCH_MAX ; slot++)
+      {
+        free(prefetch->frames[slot]);
+        prefetch->frames[slot] = NULL;
+        prefetch->used[slot] = 0;
+        prefetch->ready[slot] = 0;
+      }
+
+    prefetch->pending = -1;
+
+    return;
+  }
+
+/*
+  Function planPrefetch
+    -> Work out the likely next views from the current view and pointer ...
+      -> pointer position (<px>, <py>) of -1 means the pointer is unknown
+      -> slots whose candidate is unchanged keep their frame
+*/
+void planPrefetch(FractalPrefetch *prefetch, FractalView *view, int px, int py)
+  {
+    FractalView candidate;
+
+    int slot;
+
+    for (slot = 0 ; slot < PREFETCH_MAX ; slot++)
+      {
+        candidate = *view;
+
+        switch(slot)
+          {
+            case PREFETCH_POINTER:
+              if (px < 0)
+                {
+                  /* Nothing to predict until the pointer moves */
+                  prefetch->used[slot] = 0;
+                  if (prefetch->pending == slot)
+                    {
+                      prefetch->pending = -1;
+                    }
+                  continue;
+                }
+
+              /* Same bounds a single left-click at the pointer produces */
+              getNewBounds(&candidate, px, py, px, py);
+            break;
+            case PREFETCH_PARENT:
+              zoomOutBounds(&candidate);
+            break;
+            case PREFETCH_LEFT:
+              panBounds(&candidate, -1, 0);
+            break;
+            case PREFETCH_RIGHT:
+              panBounds(&candidate, 1, 0);
+            break;
+            case PREFETCH_UP:
+              panBounds(&candidate, 0, 1);
+            break;
+            case PREFETCH_DOWN:
+              panBounds(&candidate, 0, -1);
+            break;
+          }
+
+        if ((prefetch->used[slot] == 0) || (matchView(&prefetch->views[slot], &candidate) == 0))
+          {
+            prefetch->views[slot] = candidate;
+            prefetch->used[slot] = 1;
+            prefetch->ready[slot] = 0;
+
+            if (prefetch->pending == slot)
+              {
+                prefetch->pending = -1;
+              }
+          }
+      }
+
+    return;
+  }
+
+/*
+  Function stepPrefetch
+    -> Render the next few columns of the most likely unfinished view ...
+      -> returns 0 once every candidate is ready (nothing left to do)
+*/
+int stepPrefetch(FractalPrefetch *prefetch)
+  {
+    int slot,
+        px_end;
+
+    if (prefetch->pending == -1)
+      {
+        for (slot = 0 ; slot < PREFETCH_MAX ; slot++)
+          {
+            if ((prefetch->used[slot] == 1) && (prefetch->ready[slot] == 0))
+              {
+                break;
+              }
+          }
+
+        if (slot == PREFETCH_MAX)
+          {
+            return (0);
+          }
+
+        prefetch->pending = slot;
+        prefetch->column = 0;
+      }
+
+    slot = prefetch->pending;
+    px_end = (prefetch->column + PREFETCH_COLUMNS);
+    if (px_end > WIDTH)
+      {
+        px_end = WIDTH;
+      }
+
+    renderFractalColumns(&prefetch->views[slot], prefetch->frames[slot], prefetch->column, px_end);
+    prefetch->column = px_end;
+
+    if (prefetch->column == WIDTH)
+      {
+        equalizeFractal(&prefetch->views[slot], prefetch->frames[slot], 0, WIDTH, 0, HEIGHT);
+        prefetch->ready[slot] = 1;
+        prefetch->pending = -1;
+      }
+
+    return (1);
+  }
+
+/*
+  Function dropPrefetch
+    -> Abandon the partially rendered frame, if any ...
+      -> called as soon as real user input arrives
+*/
+void dropPrefetch(FractalPrefetch *prefetch)
+  {
+    prefetch->pending = -1;
+    prefetch->column = 0;
+
+    return;
+  }
+
+/*
+  Function fetchPrefetch
+    -> Copy a finished speculative frame matching <view> ...
+      -> returns 0 if no such frame is cached
+*/
+int fetchPrefetch
+ (FractalPrefetch *prefetch, FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH])
+  {
+    int slot;
+
+    for (slot = 0 ; slot < PREFETCH_MAX ; slot++)
+      {
+        if ((prefetch->ready[slot] == 1) && (matchView(&prefetch->views[slot], view) == 1))
+          {
+            memcpy(fractal_points, prefetch->frames[slot], sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+            return (1);
+          }
+      }
+
+    return (0);
+  }
+
+/*
+  Function matchView
+    -> Return 1 if two views would render the same frame
+*/
+int matchView(FractalView *view1, FractalView *view2)
+  {
+    return ((view1->type == view2->type) && (view1->color == view2->color) &&
+            (view1->real == view2->real) && (view1->imag == view2->imag) &&
+            (view1->iterations == view2->iterations) &&
+            (view1->xmin == view2->xmin) && (view1->xmax == view2->xmax) &&
+            (view1->ymin == view2->ymin) && (view1->ymax == view2->ymax) &&
+            (view1->xmin_lo == view2->xmin_lo) && (view1->xmax_lo == view2->xmax_lo) &&
+            (view1->ymin_lo == view2->ymin_lo) && (view1->ymax_lo == view2->ymax_lo));
+  }
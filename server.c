@@ -0,0 +1,1107 @@
+/*
+ * server.c: X-Fractals / render daemon answering tile requests over a Unix domain socket
+ *
+ * Authored by Parmjit Virk (2017)
+ *
+ * Licensed under the MIT license as per the Open Source Initiative 2017.
+ * See the LICENSE file for the complete license information,
+ * or visit https://opensource.org/licenses/MIT for details.
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <sys/un.h>
+#include <X11/Xlib.h>
+#include "Xfractals.h"
+
+/*
+  CONSTANTS
+    -> define default socket path and size limits of the daemon
+    -> a request queue of SERVER_QUEUE_MAX distinct tiles is the
+       backpressure point: while it is full no more requests are read
+    -> likewise a client owed SERVER_REPLIES_MAX replies is not read
+       from until it has taken some of them
+*/
+
+#define SERVER_SOCKET       "/tmp/xfractals.sock"
+#define SERVER_CLIENTS_MAX  32
+#define SERVER_QUEUE_MAX    16
+#define SERVER_WAITERS_MAX  32
+#define SERVER_CACHE_MAX    256
+#define SERVER_LINE_MAX     512
+#define SERVER_REPLIES_MAX  32
+#define SERVER_HEADER_MAX   96
+#define SERVER_ITER_MAX     100000
+
+/*
+  CONSTANTS
+    -> define tile encodings and render job states
+*/
+
+#define FORMAT_RAW    1
+#define FORMAT_PNG    2
+
+#define JOB_FREE      0
+#define JOB_QUEUED    1
+#define JOB_RENDERING 2
+#define JOB_DONE      3
+
+/*
+  STRUCTURES
+    -> <TileKey>, everything that decides the bytes of a tile
+    -> <TileEntry>, an encoded tile held in a memory file for sendfile
+    -> <TileJob>, a queued/rendering tile and the clients waiting for it
+    -> <TileReply>, a reply not yet fully written: the header line, then
+       bytes <offset> up to <size> of tile memory file <fd> (-1 if none)
+    -> <TileClient>, a connection, its partly read request line and its
+       queue of replies
+         -> <pending>, replies owed: queued, or waiting on a render
+         -> <closing>, the client has stopped sending; close once
+            every line it sent is answered
+*/
+
+typedef struct
+  {
+    FractalView view;
+    int         width,
+                height,
+                format;
+  } TileKey;
+
+typedef struct
+  {
+    TileKey       key;
+    int           fd;
+    size_t        size;
+    unsigned long used;
+  } TileEntry;
+
+typedef struct
+  {
+    TileKey       key;
+    int           state,
+                  fd;
+    size_t        size;
+    unsigned long order;
+    int           waiters,
+                  client[SERVER_WAITERS_MAX];
+    long          id[SERVER_WAITERS_MAX];
+  } TileJob;
+
+typedef struct
+  {
+    char   header[SERVER_HEADER_MAX];
+    int    length,
+           sent,
+           fd;
+    size_t size;
+    off_t  offset;
+  } TileReply;
+
+typedef struct
+  {
+    int       fd,
+              length;
+    char      line[SERVER_LINE_MAX];
+    TileReply replies[SERVER_REPLIES_MAX];
+    int       first,
+              count,
+              pending,
+              closing;
+  } TileClient;
+
+/* Define local function prototypes ... */
+int handleRequest(int, char *);
+void finishJobs(void);
+void closeClient(int);
+int flushReplies(int);
+void *renderJobs(void *);
+int encodeTile(TileKey *, unsigned long [][HEIGHT][POINT_DEPTH], size_t *);
+size_t encodePNG(TileKey *, unsigned long [][HEIGHT][POINT_DEPTH], unsigned char *);
+void queueTile(int, long, int, size_t);
+void queueError(int, long, char *);
+TileReply *addReply(int);
+int matchKey(TileKey *, TileKey *);
+int checkColor(int);
+unsigned long crc32(unsigned char *, size_t, unsigned long);
+void putBE32(unsigned char *, unsigned long);
+void stopServer(int);
+
+/*
+   Daemon state shared with the render thread
+     -> static vars, <jobs> guarded by <job_lock>
+*/
+
+static TileClient      clients[SERVER_CLIENTS_MAX];
+static TileEntry       cache[SERVER_CACHE_MAX];
+static TileJob         jobs[SERVER_QUEUE_MAX];
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  job_ready = PTHREAD_COND_INITIALIZER;
+static int             wake_pipe[2];
+static unsigned long   clock_tick = 0;
+static volatile sig_atomic_t running = 1;
+
+/*
+  Daemon entry point ...
+    -> usage: fractald [socket path]
+    -> one request per line, any number per connection:
+         TILE <id> <type> <color> <xmin> <ymin> <xmax> <ymax>
+              <width> <height> <iterations> RAW|PNG
+    -> each reply is "TILE <id> <bytes>" and a newline followed by the
+       tile bytes, or "ERROR <id> <reason>" and a newline; replies may
+       come back in a different order from the requests
+    -> client sockets are non-blocking: replies are queued per client
+       and written as the socket takes them, so a slow reader never
+       holds up the others
+    -> RAW tiles are row-major 32-bit little-endian 0x00RRGGBB pixels
+*/
+int main(int argc, char *argv[])
+  {
+    struct sockaddr_un address;
+    struct pollfd      polls[SERVER_CLIENTS_MAX + 2];
+
+    FractalArena arena;
+    pthread_t    thread;
+
+    char *path,
+         *newline;
+
+    char drain[64];
+
+    int listener,
+        queued,
+        count,
+        slot,
+        index,
+        bytes;
+
+    path = (argc > 1) ? argv[1] : SERVER_SOCKET;
+
+    /* Create the listening socket ... */
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    unlink(path);
+
+    if ((listener < 0) ||
+        (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0) ||
+        (listen(listener, SERVER_CLIENTS_MAX) != 0) ||
+        (pipe(wake_pipe) != 0))
+      {
+        /* Can't take any requests, so notify and quit ... */
+
+        printf("Could not listen on %s.\n", path);
+        exit(1);
+      }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, &stopServer);
+    signal(SIGTERM, &stopServer);
+
+    for (slot = 0 ; slot < SERVER_CLIENTS_MAX ; slot++)
+      {
+        clients[slot].fd = -1;
+      }
+
+    for (slot = 0 ; slot < SERVER_CACHE_MAX ; slot++)
+      {
+        cache[slot].fd = -1;
+      }
+
+    /* Start the render thread with its own frame memory ... */
+
+    getRenderThreads();
+    createArena(&arena, sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+    if (pthread_create(&thread, NULL, &renderJobs, arena.base) != 0)
+      {
+        /* Nothing would ever answer a request, so notify and quit ... */
+
+        printf("Could not start render thread.\n");
+        exit(1);
+      }
+
+    printf("Listening on %s\n", path);
+    fflush(stdout);
+
+    while (running == 1)
+      {
+        /*
+          Feed buffered request lines while the queue has room ...
+            -> a full queue, or a client owed too many replies, leaves
+               them (and the socket) unread, which blocks the client's
+               writes: backpressure
+        */
+
+        for (slot = 0 ; slot < SERVER_CLIENTS_MAX ; slot++)
+          {
+            while ((clients[slot].fd != -1) &&
+                   (clients[slot].pending < SERVER_REPLIES_MAX) &&
+                   ((newline = memchr(clients[slot].line, '\n', clients[slot].length)) != NULL))
+              {
+                *newline = '\0';
+                if (handleRequest(slot, clients[slot].line) == 0)
+                  {
+                    *newline = '\n';
+                    break;
+                  }
+
+                /* One reply is owed for every request line taken */
+
+                clients[slot].pending++;
+                clients[slot].length -= ((newline + 1) - clients[slot].line);
+                memmove(clients[slot].line, (newline + 1), clients[slot].length);
+              }
+
+            /* A client done sending is closed once every line is answered */
+
+            if ((clients[slot].fd != -1) && (clients[slot].closing == 1) &&
+                (clients[slot].pending == 0) &&
+                (memchr(clients[slot].line, '\n', clients[slot].length) == NULL))
+              {
+                closeClient(slot);
+              }
+          }
+
+        pthread_mutex_lock(&job_lock);
+        for (queued = 0, slot = 0 ; slot < SERVER_QUEUE_MAX ; slot++)
+          {
+            queued += (jobs[slot].state != JOB_FREE);
+          }
+        pthread_mutex_unlock(&job_lock);
+
+        /* Wait for connections, requests or finished renders ... */
+
+        polls[0].fd = listener;
+        polls[0].events = POLLIN;
+        polls[1].fd = wake_pipe[0];
+        polls[1].events = POLLIN;
+        count = 2;
+
+        for (slot = 0 ; slot < SERVER_CLIENTS_MAX ; slot++)
+          {
+            if (clients[slot].fd != -1)
+              {
+                polls[count].fd = clients[slot].fd;
+                polls[count].events = 0;
+
+                if ((queued < SERVER_QUEUE_MAX) && (clients[slot].closing == 0) &&
+                    (clients[slot].pending < SERVER_REPLIES_MAX) &&
+                    (clients[slot].length < SERVER_LINE_MAX))
+                  {
+                    polls[count].events |= POLLIN;
+                  }
+
+                if (clients[slot].count > 0)
+                  {
+                    polls[count].events |= POLLOUT;
+                  }
+
+                count++;
+              }
+          }
+
+        if (poll(polls, count, -1) < 0)
+          {
+            continue;
+          }
+
+        if (polls[1].revents & POLLIN)
+          {
+            read(wake_pipe[0], drain, sizeof(drain));
+            finishJobs();
+          }
+
+        if (polls[0].revents & POLLIN)
+          {
+            for (slot = 0 ; (slot < SERVER_CLIENTS_MAX) && (clients[slot].fd != -1) ; slot++);
+
+            if (slot < SERVER_CLIENTS_MAX)
+              {
+                clients[slot].fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK);
+                clients[slot].length = 0;
+                clients[slot].first = 0;
+                clients[slot].count = 0;
+                clients[slot].pending = 0;
+                clients[slot].closing = 0;
+              }
+            else
+              {
+                /* No room for another client, turn it away */
+                close(accept(listener, NULL, NULL));
+              }
+          }
+
+        for (index = 2 ; index < count ; index++)
+          {
+            if (polls[index].revents == 0)
+              {
+                continue;
+              }
+
+            for (slot = 0 ; clients[slot].fd != polls[index].fd ; slot++);
+
+            /* Gone, or its replies can no longer be written */
+
+            if ((polls[index].revents & (POLLHUP | POLLERR)) ||
+                ((polls[index].revents & POLLOUT) && (flushReplies(slot) == 0)))
+              {
+                closeClient(slot);
+                continue;
+              }
+
+            if ((polls[index].revents & POLLIN) == 0)
+              {
+                continue;
+              }
+
+            bytes = read(clients[slot].fd, (clients[slot].line + clients[slot].length),
+                         (SERVER_LINE_MAX - clients[slot].length));
+
+            if (bytes == 0)
+              {
+                /* Done sending, but still owed replies */
+                clients[slot].closing = 1;
+              }
+            else if ((bytes < 0) && (errno != EAGAIN) && (errno != EINTR))
+              {
+                closeClient(slot);
+              }
+            else if (bytes > 0)
+              {
+                clients[slot].length += bytes;
+
+                if ((clients[slot].length == SERVER_LINE_MAX) &&
+                    (memchr(clients[slot].line, '\n', SERVER_LINE_MAX) == NULL))
+                  {
+                    queueError(slot, 0, "request line too long");
+                    clients[slot].pending++;
+                    clients[slot].closing = 1;
+                  }
+              }
+          }
+      }
+
+    /* Remove the socket and exit, taking the render thread with us */
+
+    close(listener);
+    unlink(path);
+
+    return (0);
+  }
+
+/*
+  Function handleRequest
+    -> Answer one request line from client <slot> ...
+      -> from the cache if possible, else by joining an identical job
+         already in flight, else by queueing a new job
+      -> returns 0 if the queue is full and the line must wait
+*/
+int handleRequest(int slot, char *line)
+  {
+    TileKey     key;
+    TileJob     *job;
+    FractalView defaults;
+
+    char format[16];
+    long id;
+    int  found,
+         index;
+
+    id = 0;
+    memset(&key, 0, sizeof(key));
+
+    if (sscanf(line, "TILE %ld %d %d %lf %lf %lf %lf %d %d %d %15s", &id,
+               &key.view.type, &key.view.color, &key.view.xmin, &key.view.ymin,
+               &key.view.xmax, &key.view.ymax, &key.width, &key.height,
+               &key.view.iterations, format) != 11)
+      {
+        queueError(slot, id, "malformed request");
+        return (1);
+      }
+
+    key.format = (strcmp(format, "RAW") == 0) ? FORMAT_RAW :
+                 (strcmp(format, "PNG") == 0) ? FORMAT_PNG : 0;
+
+    if ((key.view.type < 1) || (key.view.type > 3) ||
+        (checkColor(key.view.color) == 0) ||
+        (key.width < 1) || (key.width > WIDTH) ||
+        (key.height < 1) || (key.height > HEIGHT) ||
+        (key.view.iterations < 1) || (key.view.iterations > SERVER_ITER_MAX) ||
+        (isfinite(key.view.xmax - key.view.xmin) == 0) ||
+        (isfinite(key.view.ymax - key.view.ymin) == 0) ||
+        (key.view.xmax <= key.view.xmin) || (key.view.ymax <= key.view.ymin) ||
+        (key.format == 0))
+      {
+        queueError(slot, id, "bad parameters");
+        return (1);
+      }
+
+    /* Same fractal constants as a first view of this type ... */
+
+    defaults.type = key.view.type;
+    getNewBounds(&defaults, -1, 0, 0, 0);
+    key.view.real = defaults.real;
+    key.view.imag = defaults.imag;
+
+    /* Cached already? */
+
+    for (index = 0 ; index < SERVER_CACHE_MAX ; index++)
+      {
+        if ((cache[index].fd != -1) && (matchKey(&cache[index].key, &key) == 1))
+          {
+            cache[index].used = ++clock_tick;
+            queueTile(slot, id, cache[index].fd, cache[index].size);
+            return (1);
+          }
+      }
+
+    pthread_mutex_lock(&job_lock);
+
+    /* Identical tile in flight? Then wait for that one ... */
+
+    found = -1;
+    for (index = 0 ; index < SERVER_QUEUE_MAX ; index++)
+      {
+        if ((jobs[index].state != JOB_FREE) && (matchKey(&jobs[index].key, &key) == 1))
+          {
+            found = index;
+            break;
+          }
+      }
+
+    /* Otherwise take a free job slot, if there is one */
+
+    if (found == -1)
+      {
+        for (index = 0 ; index < SERVER_QUEUE_MAX ; index++)
+          {
+            if (jobs[index].state == JOB_FREE)
+              {
+                found = index;
+                jobs[index].key = key;
+                jobs[index].state = JOB_QUEUED;
+                jobs[index].order = ++clock_tick;
+                jobs[index].waiters = 0;
+                pthread_cond_signal(&job_ready);
+                break;
+              }
+          }
+      }
+
+    if ((found == -1) || (jobs[found].waiters == SERVER_WAITERS_MAX))
+      {
+        pthread_mutex_unlock(&job_lock);
+        return (0);
+      }
+
+    job = &jobs[found];
+    job->client[job->waiters] = slot;
+    job->id[job->waiters] = id;
+    job->waiters++;
+
+    pthread_mutex_unlock(&job_lock);
+
+    return (1);
+  }
+
+/*
+  Function finishJobs
+    -> Move finished tiles into the cache and answer their waiters ...
+      -> the least recently used tile is evicted when the cache is full
+*/
+void finishJobs(void)
+  {
+    int index,
+        slot,
+        oldest,
+        waiter;
+
+    pthread_mutex_lock(&job_lock);
+
+    for (index = 0 ; index < SERVER_QUEUE_MAX ; index++)
+      {
+        if (jobs[index].state != JOB_DONE)
+          {
+            continue;
+          }
+
+        if (jobs[index].fd != -1)
+          {
+            oldest = 0;
+            for (slot = 0 ; slot < SERVER_CACHE_MAX ; slot++)
+              {
+                if (cache[slot].fd == -1)
+                  {
+                    oldest = slot;
+                    break;
+                  }
+
+                if (cache[slot].used < cache[oldest].used)
+                  {
+                    oldest = slot;
+                  }
+              }
+
+            if (cache[oldest].fd != -1)
+              {
+                close(cache[oldest].fd);
+              }
+
+            cache[oldest].key = jobs[index].key;
+            cache[oldest].fd = jobs[index].fd;
+            cache[oldest].size = jobs[index].size;
+            cache[oldest].used = ++clock_tick;
+          }
+
+        for (waiter = 0 ; waiter < jobs[index].waiters ; waiter++)
+          {
+            if (jobs[index].client[waiter] == -1)
+              {
+                continue;
+              }
+
+            if (jobs[index].fd == -1)
+              {
+                queueError(jobs[index].client[waiter], jobs[index].id[waiter], "render failed");
+              }
+            else
+              {
+                queueTile(jobs[index].client[waiter], jobs[index].id[waiter],
+                          jobs[index].fd, jobs[index].size);
+              }
+          }
+
+        jobs[index].state = JOB_FREE;
+      }
+
+    pthread_mutex_unlock(&job_lock);
+
+    return;
+  }
+
+/*
+  Function closeClient
+    -> Drop a connection, its unsent replies and any tiles it was
+       waiting for
+*/
+void closeClient(int slot)
+  {
+    int index,
+        waiter;
+
+    pthread_mutex_lock(&job_lock);
+
+    for (index = 0 ; index < SERVER_QUEUE_MAX ; index++)
+      {
+        for (waiter = 0 ; waiter < jobs[index].waiters ; waiter++)
+          {
+            if (jobs[index].client[waiter] == slot)
+              {
+                jobs[index].client[waiter] = -1;
+              }
+          }
+      }
+
+    pthread_mutex_unlock(&job_lock);
+
+    for ( ; clients[slot].count > 0 ; clients[slot].count--)
+      {
+        if (clients[slot].replies[clients[slot].first].fd != -1)
+          {
+            close(clients[slot].replies[clients[slot].first].fd);
+          }
+        clients[slot].first = ((clients[slot].first + 1) % SERVER_REPLIES_MAX);
+      }
+
+    close(clients[slot].fd);
+    clients[slot].fd = -1;
+    clients[slot].length = 0;
+    clients[slot].pending = 0;
+    clients[slot].closing = 0;
+
+    return;
+  }
+
+/*
+  Function flushReplies
+    -> Write as much of client <slot>'s reply queue as its socket takes ...
+      -> header line, then the tile bytes straight from the memory file
+         (sendfile, no copy through user space)
+      -> returns 0 if the connection failed and must be closed
+*/
+int flushReplies(int slot)
+  {
+    TileReply *reply;
+
+    ssize_t sent;
+
+    while (clients[slot].count > 0)
+      {
+        reply = &clients[slot].replies[clients[slot].first];
+
+        if (reply->sent < reply->length)
+          {
+            sent = send(clients[slot].fd, (reply->header + reply->sent),
+                        (reply->length - reply->sent), MSG_NOSIGNAL);
+            if (sent > 0)
+              {
+                reply->sent += sent;
+                continue;
+              }
+          }
+        else if (reply->offset < (off_t)reply->size)
+          {
+            /* advances <offset> by the bytes sent */
+            sent = sendfile(clients[slot].fd, reply->fd, &reply->offset,
+                            (reply->size - reply->offset));
+            if (sent > 0)
+              {
+                continue;
+              }
+          }
+        else
+          {
+            /* Reply complete, on to the next one */
+
+            if (reply->fd != -1)
+              {
+                close(reply->fd);
+              }
+
+            clients[slot].first = ((clients[slot].first + 1) % SERVER_REPLIES_MAX);
+            clients[slot].count--;
+            clients[slot].pending--;
+            continue;
+          }
+
+        /* Socket full, so wait for the next POLLOUT, or failed */
+
+        return ((sent < 0) && ((errno == EAGAIN) || (errno == EINTR)));
+      }
+
+    return (1);
+  }
+
+/*
+  Function renderJobs
+    -> Render thread body: take the oldest queued job, render and encode it ...
+      -> wakes the main loop through <wake_pipe> once each job is done
+*/
+void *renderJobs(void *arg)
+  {
+    unsigned long (*fractal_points)[HEIGHT][POINT_DEPTH];
+
+    TileKey key;
+    size_t  size;
+
+    int index,
+        oldest,
+        fd;
+
+    fractal_points = arg;
+
+    while (1)
+      {
+        pthread_mutex_lock(&job_lock);
+
+        oldest = -1;
+        while (oldest == -1)
+          {
+            for (index = 0 ; index < SERVER_QUEUE_MAX ; index++)
+              {
+                if ((jobs[index].state == JOB_QUEUED) &&
+                    ((oldest == -1) || (jobs[index].order < jobs[oldest].order)))
+                  {
+                    oldest = index;
+                  }
+              }
+
+            if (oldest == -1)
+              {
+                pthread_cond_wait(&job_ready, &job_lock);
+              }
+          }
+
+        jobs[oldest].state = JOB_RENDERING;
+        key = jobs[oldest].key;
+
+        pthread_mutex_unlock(&job_lock);
+
+        fd = encodeTile(&key, fractal_points, &size);
+
+        pthread_mutex_lock(&job_lock);
+        jobs[oldest].fd = fd;
+        jobs[oldest].size = size;
+        jobs[oldest].state = JOB_DONE;
+        pthread_mutex_unlock(&job_lock);
+
+        write(wake_pipe[1], "!", 1);
+      }
+
+    return (NULL);
+  }
+
+/*
+  Function encodeTile
+    -> Render a tile and store its encoded bytes in a memory file ...
+      -> the tile is the top-left <width> x <height> corner of a window
+         whose pixel spacing matches the requested bounds
+      -> returns the file descriptor, or -1 on failure
+*/
+int encodeTile(TileKey *key, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], size_t *size)
+  {
+    FractalView view;
+
+    unsigned char *bytes;
+
+    double x_inc,
+           y_inc;
+
+    unsigned long pixel;
+
+    size_t done;
+    int    fd,
+           px,
+           py,
+           written;
+
+    view = key->view;
+    x_inc = ((view.xmax - view.xmin) / key->width);
+    y_inc = ((view.ymax - view.ymin) / key->height);
+    view.xmax = (view.xmin + (x_inc * WIDTH));
+    view.ymin = (view.ymax - (y_inc * HEIGHT));
+
+    renderFractalTile(&view, fractal_points, 0, key->width, 0, key->height);
+    equalizeFractal(&view, fractal_points, 0, key->width, 0, key->height);
+
+    /* Room for either encoding, PNG adds framing to each row and block */
+
+    bytes = malloc((key->width * key->height * 4) + (key->height * 1) +
+                   ((((key->width * 3) + 1) * key->height) / 65535 + 1) * 5 + 64);
+    if (bytes == NULL)
+      {
+        return (-1);
+      }
+
+    if (key->format == FORMAT_PNG)
+      {
+        *size = encodePNG(key, fractal_points, bytes);
+      }
+    else
+      {
+        *size = 0;
+        for (py = 0 ; py < key->height ; py++)
+          {
+            for (px = 0 ; px < key->width ; px++)
+              {
+                pixel = (fractal_points[px][py][POINT_COLOR] & 0xFFFFFF);
+                bytes[(*size)++] = (pixel & 0xFF);
+                bytes[(*size)++] = ((pixel >> 8) & 0xFF);
+                bytes[(*size)++] = ((pixel >> 16) & 0xFF);
+                bytes[(*size)++] = 0;
+              }
+          }
+      }
+
+    fd = memfd_create("xfractals-tile", 0);
+    for (done = 0 ; (fd != -1) && (done < *size) ; done += written)
+      {
+        written = write(fd, (bytes + done), (*size - done));
+        if (written <= 0)
+          {
+            close(fd);
+            fd = -1;
+          }
+      }
+
+    free(bytes);
+
+    return (fd);
+  }
+
+/*
+  Function encodePNG
+    -> Write a tile as an 8-bit RGB PNG into <bytes>, returning its size ...
+      -> image data uses stored (uncompressed) deflate blocks, so no
+         compression library is needed
+*/
+size_t encodePNG(TileKey *key, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], unsigned char *bytes)
+  {
+    static unsigned char signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+
+    unsigned long adler_a,
+                  adler_b,
+                  pixel;
+
+    size_t raw_size,
+           size,
+           idat,
+           block,
+           left;
+
+    int px,
+        py,
+        channel;
+
+    unsigned char *data;
+
+    raw_size = (((key->width * 3) + 1) * key->height);
+
+    memcpy(bytes, signature, 8);
+
+    /* IHDR: width, height, 8-bit depth, RGB, no interlace */
+
+    putBE32(bytes + 8, 13);
+    memcpy(bytes + 12, "IHDR", 4);
+    putBE32(bytes + 16, key->width);
+    putBE32(bytes + 20, key->height);
+    bytes[24] = 8;
+    bytes[25] = 2;
+    bytes[26] = 0;
+    bytes[27] = 0;
+    bytes[28] = 0;
+    putBE32(bytes + 29, crc32(bytes + 12, 17, 0));
+
+    /* IDAT: zlib stream of stored blocks holding the filtered rows */
+
+    idat = 33;
+    memcpy(bytes + idat + 4, "IDAT", 4);
+    size = (idat + 8);
+    bytes[size++] = 0x78;
+    bytes[size++] = 0x01;
+
+    adler_a = 1;
+    adler_b = 0;
+    left = raw_size;
+    block = 0;
+
+    for (py = 0 ; py < key->height ; py++)
+      {
+        for (px = -1 ; px < key->width ; px++)
+          {
+            for (channel = 0 ; channel < ((px == -1) ? 1 : 3) ; channel++)
+              {
+                if (block == 0)
+                  {
+                    /* Start a stored block of up to 65535 bytes */
+
+                    block = (left > 65535) ? 65535 : left;
+                    bytes[size++] = (left == block) ? 1 : 0;
+                    bytes[size++] = (block & 0xFF);
+                    bytes[size++] = ((block >> 8) & 0xFF);
+                    bytes[size++] = (~block & 0xFF);
+                    bytes[size++] = ((~block >> 8) & 0xFF);
+                  }
+
+                /* Filter byte 0 (none) starts each row */
+
+                pixel = (px == -1) ? 0 : fractal_points[px][py][POINT_COLOR];
+                data = &bytes[size++];
+                *data = (px == -1) ? 0 : ((pixel >> (16 - (channel * 8))) & 0xFF);
+
+                adler_a = ((adler_a + *data) % 65521);
+                adler_b = ((adler_b + adler_a) % 65521);
+                block--;
+                left--;
+              }
+          }
+      }
+
+    putBE32(bytes + size, ((adler_b << 16) | adler_a));
+    size += 4;
+
+    putBE32(bytes + idat, (size - (idat + 8)));
+    putBE32(bytes + size, crc32(bytes + idat + 4, (size - (idat + 4)), 0));
+    size += 4;
+
+    /* IEND */
+
+    putBE32(bytes + size, 0);
+    memcpy(bytes + size + 4, "IEND", 4);
+    putBE32(bytes + size + 8, crc32(bytes + size + 4, 4, 0));
+    size += 12;
+
+    return (size);
+  }
+
+/*
+  Function queueTile
+    -> Queue a tile reply to client <slot>: header, then the bytes of
+       memory file <tile_fd> ...
+      -> holds its own descriptor, so the cache may evict the tile
+         before the reply is written
+*/
+void queueTile(int slot, long id, int tile_fd, size_t size)
+  {
+    TileReply *reply;
+
+    reply = addReply(slot);
+    reply->fd = dup(tile_fd);
+
+    if (reply->fd == -1)
+      {
+        reply->length = snprintf(reply->header, SERVER_HEADER_MAX, "ERROR %ld %s\n", id, "server busy");
+        return;
+      }
+
+    reply->length = snprintf(reply->header, SERVER_HEADER_MAX, "TILE %ld %lu\n", id, (unsigned long)size);
+    reply->size = size;
+
+    return;
+  }
+
+/*
+  Function queueError
+    -> Queue a reply to client <slot> that request <id> could not be answered
+*/
+void queueError(int slot, long id, char *reason)
+  {
+    TileReply *reply;
+
+    reply = addReply(slot);
+    reply->length = snprintf(reply->header, SERVER_HEADER_MAX, "ERROR %ld %s\n", id, reason);
+    reply->length = (reply->length >= SERVER_HEADER_MAX) ? (SERVER_HEADER_MAX - 1) : reply->length;
+
+    return;
+  }
+
+/*
+  Function addReply
+    -> Return a cleared entry at the back of client <slot>'s reply queue ...
+      -> never full: a client owed SERVER_REPLIES_MAX replies sends no
+         more requests until some are written
+*/
+TileReply *addReply(int slot)
+  {
+    TileReply *reply;
+
+    reply = &clients[slot].replies[(clients[slot].first + clients[slot].count) % SERVER_REPLIES_MAX];
+    clients[slot].count++;
+
+    reply->length = 0;
+    reply->sent = 0;
+    reply->fd = -1;
+    reply->size = 0;
+    reply->offset = 0;
+
+    return (reply);
+  }
+
+/*
+  Function matchKey
+    -> Return 1 if two requests produce the same tile bytes
+*/
+int matchKey(TileKey *key1, TileKey *key2)
+  {
+    return ((key1->view.type == key2->view.type) && (key1->view.color == key2->view.color) &&
+            (key1->view.iterations == key2->view.iterations) &&
+            (key1->view.xmin == key2->view.xmin) && (key1->view.xmax == key2->view.xmax) &&
+            (key1->view.ymin == key2->view.ymin) && (key1->view.ymax == key2->view.ymax) &&
+            (key1->width == key2->width) && (key1->height == key2->height) &&
+            (key1->format == key2->format));
+  }
+
+/*
+  Function checkColor
+   -> Return 1 if color scheme <color> can be served ...
+     -> the distance and orbit trap schemes only when compiled in
+*/
+int checkColor(int color)
+  {
+#ifndef FRACTAL_DISTANCE
+    if (color == COLOR_DISTANCE)
+      {
+        return (0);
+      }
+#endif
+#ifndef FRACTAL_ORBIT_TRAP
+    if (color == COLOR_TRAP)
+      {
+        return (0);
+      }
+#endif
+
+    return ((color >= 1) && (color <= COLOR_EQUALIZED));
+  }
+
+/*
+  Function crc32
+    -> Continue the PNG/zlib CRC-32 of <crc> over <size> bytes
+*/
+unsigned long crc32(unsigned char *bytes, size_t size, unsigned long crc)
+  {
+    /*
+       Retain the lookup table in memory even after function terminates!
+         -> static var, built on first use
+    */
+
+    static unsigned long table[256];
+    static int           ready = 0;
+
+    unsigned long value;
+    size_t        index;
+    int           bit;
+
+    if (ready == 0)
+      {
+        for (index = 0 ; index < 256 ; index++)
+          {
+            value = index;
+            for (bit = 0 ; bit < 8 ; bit++)
+              {
+                value = (value & 1) ? (0xEDB88320UL ^ (value >> 1)) : (value >> 1);
+              }
+            table[index] = value;
+          }
+        ready = 1;
+      }
+
+    crc = (crc ^ 0xFFFFFFFFUL);
+    for (index = 0 ; index < size ; index++)
+      {
+        crc = (table[(crc ^ bytes[index]) & 0xFF] ^ (crc >> 8));
+      }
+
+    return (crc ^ 0xFFFFFFFFUL);
+  }
+
+/*
+  Function putBE32
+    -> Store a 32-bit value most significant byte first
+*/
+void putBE32(unsigned char *bytes, unsigned long value)
+  {
+    bytes[0] = ((value >> 24) & 0xFF);
+    bytes[1] = ((value >> 16) & 0xFF);
+    bytes[2] = ((value >> 8) & 0xFF);
+    bytes[3] = (value & 0xFF);
+
+    return;
+  }
+
+/*
+  Function stopServer
+    -> Signal handler, leave the main loop so the socket is removed
+*/
+void stopServer(int signal_number)
+  {
+    running = 0;
+
+    return;
+  }
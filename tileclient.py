@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+#
+# tileclient.py: X-Fractals / test client for the fractald tile daemon
+#
+# Licensed under the MIT license as per the Open Source Initiative 2017.
+# See the LICENSE file for the complete license information,
+# or visit https://opensource.org/licenses/MIT for details.
+#
+# usage: tileclient.py [socket path]
+#
+#   -> sends one batch of requests (RAW and PNG tiles, duplicates,
+#      malformed and out-of-range lines) and checks every reply: PNG
+#      chunk CRCs and zlib stream, RAW tile sizes, identical bytes for
+#      identical requests, and an ERROR for each bad line
+#   -> then checks that a client which never reads its replies does not
+#      hold up another client, and that a client which stops sending
+#      still gets every reply when its requests had to wait for room
+#
+
+import socket
+import struct
+import sys
+import time
+import zlib
+
+SOCKET = '/tmp/xfractals.sock'
+
+
+def connect(path):
+    client = socket.socket(socket.AF_UNIX)
+    client.connect(path)
+    client.settimeout(30)
+    return client
+
+
+def read_replies(client, count):
+    """Read <count> replies, returning {id: bytes} and {id: reason}."""
+    stream = client.makefile('rb')
+    tiles, errors = {}, {}
+    while len(tiles) + len(errors) < count:
+        line = stream.readline().decode().split()
+        if not line:
+            raise RuntimeError('connection closed after %d replies'
+                               % (len(tiles) + len(errors)))
+        if line[0] == 'ERROR':
+            errors[int(line[1])] = ' '.join(line[2:])
+        else:
+            tiles[int(line[1])] = stream.read(int(line[2]))
+    return tiles, errors
+
+
+def check_png(data, width, height):
+    assert data[:8] == b'\x89PNG\r\n\x1a\n', 'bad PNG signature'
+    position, idat = 8, b''
+    while position < len(data):
+        length, = struct.unpack('>I', data[position:position + 4])
+        kind = data[position + 4:position + 8]
+        body = data[position + 8:position + 8 + length]
+        crc, = struct.unpack('>I', data[position + 8 + length:position + 12 + length])
+        assert zlib.crc32(kind + body) & 0xFFFFFFFF == crc, 'bad %s CRC' % kind
+        if kind == b'IDAT':
+            idat += body
+        position += 12 + length
+    assert len(zlib.decompress(idat)) == ((width * 3) + 1) * height, 'bad IDAT size'
+
+
+def check_batch(path):
+    requests, bad = [], []
+    for index in range(40):
+        # every 20th tile repeats an earlier one
+        fmt = 'PNG' if index % 2 else 'RAW'
+        ymin = -1.5 + (index % 20) * 0.01
+        requests.append('TILE %d 1 1 -2.5 %g 1.5 1.5 64 48 155 %s\n' % (index, ymin, fmt))
+    for index, line in enumerate(['TILE %d 9 1 0 0 1 1 4 4 10 RAW\n',
+                                  'TILE %d 1 1 1 0 0 1 4 4 10 RAW\n',
+                                  'TILE %d 1 1 nan 0 1 1 4 4 10 RAW\n',
+                                  'TILE %d 1 1 0 0 inf 1 4 4 10 RAW\n',
+                                  'TILE %d 1 1 -1e308 0 1e308 1 4 4 10 RAW\n',
+                                  'TILE %d 1 1 0 0 1 1 4 4 10 GIF\n',
+                                  'TILE %d 1 11 -0.2 -0.1 -0.1 0.0 16 16 155 RAW\n']):
+        bad.append(100 + index)
+        requests.append(line % (100 + index))
+    requests.append('garbage\n')
+
+    client = connect(path)
+    client.sendall(''.join(requests).encode())
+    tiles, errors = read_replies(client, len(requests))
+    client.close()
+
+    for index in range(40):
+        if index % 2:
+            check_png(tiles[index], 64, 48)
+        else:
+            assert len(tiles[index]) == 64 * 48 * 4, 'bad RAW size'
+    for index in range(20):
+        assert tiles[index] == tiles[index + 20], 'duplicate %d differs' % index
+    # the last bad line is valid: an equalized tile where nothing escapes
+    assert sorted(errors) == [0] + bad[:-1], sorted(errors)
+    assert tiles[bad[-1]] == bytes(16 * 16 * 4), 'escape-free tile not black'
+    print('batch: %d tiles, %d errors ok' % (len(tiles), len(errors)))
+
+
+def check_slow_reader(path):
+    # a client asking for far more than its socket buffer holds, never reading
+    slow = connect(path)
+    slow.setblocking(False)
+    lines = ''.join('TILE %d 1 1 -2.5 %g 1.5 1.5 400 400 155 RAW\n' % (index, -1.5 + index * 1e-3)
+                    for index in range(200))
+    try:
+        slow.send(lines.encode())
+    except BlockingIOError:
+        pass
+    time.sleep(1.0)
+
+    fast = connect(path)
+    start = time.time()
+    fast.sendall(b'TILE 1 1 1 -2.5 -1.5 1.5 1.5 16 16 155 RAW\n')
+    tiles, errors = read_replies(fast, 1)
+    fast.close()
+    slow.close()
+
+    assert 1 in tiles, errors
+    print('slow reader: other client answered in %.3f s' % (time.time() - start))
+
+
+def check_shared_waiters(path):
+    # more identical requests than one render can have waiters, the second
+    # client's extra lines wait in its buffer after it has stopped sending
+    line = b'TILE %d 1 1 -2.5 -1.5 1.5 1.5 400 400 3000 RAW\n'
+    first = connect(path)
+    first.sendall(b''.join(line % index for index in range(20)))
+    second = connect(path)
+    second.sendall(b''.join(line % index for index in range(20)))
+    second.shutdown(socket.SHUT_WR)
+
+    for client in (second, first):
+        tiles, errors = read_replies(client, 20)
+        assert len(tiles) == 20, errors
+        client.close()
+    print('shared waiters: every request answered')
+
+
+if __name__ == '__main__':
+    path = sys.argv[1] if len(sys.argv) > 1 else SOCKET
+    check_batch(path)
+    check_slow_reader(path)
+    check_shared_waiters(path)
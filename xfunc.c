@@ -11,13 +11,52 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/Xos.h>
+#include <X11/keysym.h>
 #include "Xfractals.h"
 
+/* 
+  Define the state of one fractal window's event loop ...
+    -> <history>, previously rendered views for undo/redo
+    -> <prefetch>, likely next views rendered while waiting for input
+    -> <zoom>, refinement state of a smoothly zoomed frame
+    -> <pointer_x>/<pointer_y>, last pointer position (-1 if unknown)
+    -> <px1>/<py1>, <px2>/<py2>, region selection press/release points
+*/
+
+typedef struct
+  {
+    Window          *window;
+    GC              *gc;
+    XImage          **image;
+    unsigned long   (*fractal_points)[HEIGHT][POINT_DEPTH];
+    FractalView     *view;
+    FractalHistory  history;
+    FractalPrefetch prefetch;
+    FractalZoom     zoom;
+    int             pointer_x,
+                    pointer_y,
+                    px1,
+                    py1,
+                    px2,
+                    py2;
+  } FractalWindow;
+
 /* Define local function prototypes ... */
+void openFractalWindow(FractalWindow *, Window *, GC *, XImage **, unsigned long [][HEIGHT][POINT_DEPTH], FractalView *);
+void closeFractalWindow(Display *, FractalWindow *);
+int idleFractalWindow(Display *, FractalWindow *);
+void keepView(FractalWindow *);
+void settleZoom(Display *, FractalWindow *);
+int handleWindowEvent(Display *, int, FractalWindow *, XEvent *, Atom);
+int checkQuitEvent(XEvent *, Atom);
+int trackHotSpot(Display *, int, Window *, GC *, XEvent *, int *, int *, int *, int *);
 void drawHotSpot(Display *, int, Window *, GC *, int, int, int, int);
+void renderView(FractalView *, unsigned long [][HEIGHT][POINT_DEPTH], FractalHistory *, FractalPrefetch *);
+int stepZoom(Display *, Window *, GC *, XImage *, unsigned long [][HEIGHT][POINT_DEPTH], FractalView *, FractalZoom *, int, int, double);
 
 /* 
   Function openDisplay
@@ -75,8 +114,8 @@ void createWindow
     /* 
       Set window attributes ...
         -> use default (hardware) colormap, black background, no border
-        -> listen only for expose, key and button press/release, and 
-           window structure change events
+        -> listen only for expose, key and button press/release, pointer
+           motion and window structure change events
     */
 
     winAttrib.colormap = DefaultColormap(display, screen);
@@ -84,7 +123,7 @@ void createWindow
     winAttrib.border_pixel = 0;
     winAttrib.event_mask = ExposureMask | ButtonPressMask | 
                            ButtonReleaseMask | KeyPressMask | 
-                           StructureNotifyMask;
+                           PointerMotionMask | StructureNotifyMask;
 
     /* 
       Create the new window ...
@@ -136,29 +175,20 @@ void createWindow
     -> Show window and wait for user input
 */
 void showWindow
- (Display *display, int screen, Window *window, GC *gc, 
-  unsigned long fractal_points[][HEIGHT][1], int fractal_type, int fractal_color)
+ (Display *display, int screen, Window *window, GC *gc, XImage **image, 
+  unsigned long fractal_points[][HEIGHT][POINT_DEPTH], FractalView *view)
   {
-    int px1,
-        px2,
-        py1,
-        py2;
-
     int continueLoop;
 
     Atom wmDeleteWindow;
 
     /* <XEvent>, event structure */
 
-    XEvent event; 
-
-    /* <key>, structure to hold keyboard input info */
-
-    KeySym key;
+    XEvent event;
 
-    /* <keyPress>, char array to store entered keystrokes ... */
+    /* <fractal_window>, the window with its view, history and caches */
 
-    char keyPress[255];
+    FractalWindow fractal_window;
 
     /* Allow window manager to terminate window cleanly via "Close" button */
 
@@ -167,6 +197,7 @@ void showWindow
     /* Map window to screen ... */
 
     XMapWindow(display, *window);
+    openFractalWindow(&fractal_window, window, gc, image, fractal_points, view);
 
     /* 
       Begin window event loop ...
@@ -176,88 +207,545 @@ void showWindow
     continueLoop = 1;
     while(continueLoop == 1)
       {
+        /* Use idle time to refine or prefetch, checking for input in between */
+
+        if ((XPending(display) == 0) && (idleFractalWindow(display, &fractal_window) == 1))
+          {
+            continue;
+          }
+
         /* 
            Grab next event from event queue ...
              -> process based on <event.type> header
         */
 
+        XNextEvent(display, &event);
+        continueLoop = handleWindowEvent(display, screen, &fractal_window, &event, wmDeleteWindow);
+      }
+
+    closeFractalWindow(display, &fractal_window);
+
+    return;
+  }
+
+/* 
+  Function showExplorer
+    -> Show a Mandelbrot window linked to a Julia window and wait for input ...
+      -> the Mandelbrot window behaves as in showWindow (history,
+         prefetch, smooth zoom)
+      -> the Julia constant follows the pointer over the Mandelbrot window
+      -> each new constant is previewed at low resolution then refined at
+         full resolution, a few columns at a time
+      -> a newer pointer position cancels any render still in progress
+*/
+void showExplorer
+ (Display *display, int screen, Window *window, GC *gc, XImage **image,
+  unsigned long fractal_points[][HEIGHT][POINT_DEPTH], FractalView *view,
+  Window *julia_window, GC *julia_gc, XImage **julia_image,
+  unsigned long julia_points[][HEIGHT][POINT_DEPTH], FractalView *julia_view)
+  {
+    int px1,
+        px2,
+        py1,
+        py2;
+
+    /* <julia_step>, resolution of the Julia render in progress (0 if none) */
+
+    int julia_column,
+        julia_step,
+        px_end;
+
+    int continueLoop;
+
+    Atom wmDeleteWindow;
+
+    XEvent event;
+
+    FractalWindow fractal_window;
+
+    /* Allow window manager to terminate windows cleanly via "Close" button */
+
+    wmDeleteWindow = XInternAtom(display, "WM_DELETE_WINDOW", False);
+
+    /* Map both windows to screen ... */
+
+    XMapWindow(display, *window);
+    XMapWindow(display, *julia_window);
+    openFractalWindow(&fractal_window, window, gc, image, fractal_points, view);
+
+    julia_column = 0;
+    julia_step = 0;
+
+    /* 
+      Begin window event loop ...
+        -> terminate on 'q', mouse right-click or winmanager close
+    */
+
+    continueLoop = 1;
+    while(continueLoop == 1)
+      {
+        /* 
+           Use idle time to continue the Julia render ...
+             -> one short step at a time, checking for input in between
+             -> then the Mandelbrot window's own refinement and prefetch
+        */
+
+        if ((XPending(display) == 0) && (julia_step > 0))
+          {
+            px_end = (julia_column + (EXPLORER_COLUMNS * julia_step));
+            px_end = (px_end > WIDTH) ? WIDTH : px_end;
+
+            renderFractalSampled(julia_view, julia_points, julia_column, px_end, 0, HEIGHT, julia_step);
+            julia_column = px_end;
+
+            if (julia_column == WIDTH)
+              {
+                /* Show the finished frame, then refine a preview */
+                equalizeFractal(julia_view, julia_points, 0, WIDTH, 0, HEIGHT);
+                drawFractal(display, julia_window, julia_gc, *julia_image, julia_points);
+                julia_column = 0;
+                julia_step = (julia_step > 1) ? 1 : 0;
+              }
+            continue;
+          }
+
+        if ((XPending(display) == 0) && (idleFractalWindow(display, &fractal_window) == 1))
+          {
+            continue;
+          }
+
         XNextEvent(display, &event);
 
-        switch(event.type)
+        if (event.xany.window != *julia_window)
           {
-            case(Expose):
-              /* redraw contents of window ... */
-              drawFractal(display, window, gc, fractal_points);
-            break;
+            continueLoop = handleWindowEvent(display, screen, &fractal_window, &event, wmDeleteWindow);
+
+            if ((event.type == MotionNotify) && (fractal_window.pointer_x >= 0))
+              {
+                /* pick the Julia constant under the pointer, dropping any stale frame */
+                getPoint(view, fractal_window.pointer_x, fractal_window.pointer_y,
+                         &julia_view->real, &julia_view->imag);
+                julia_column = 0;
+                julia_step = PREVIEW_STEP;
+              }
+            continue;
+          }
+
+        /* Julia window: redraw, quit, or select a new region ... */
+
+        if (event.type == Expose)
+          {
+            drawFractal(display, julia_window, julia_gc, *julia_image, julia_points);
+          }
+        else if (checkQuitEvent(&event, wmDeleteWindow) == 1)
+          {
+            continueLoop = 0;
+          }
+        else if (trackHotSpot(display, screen, julia_window, julia_gc, &event,
+                              &px1, &py1, &px2, &py2) == 1)
+          {
+            /* move the Julia view, rendered while idle */
+            getNewBounds(julia_view, px1, py1, px2, py2);
+            julia_column = 0;
+            julia_step = PREVIEW_STEP;
+          }
+      }
+
+    /* Free the Julia image, graphics context and window, then the Mandelbrot's */
 
-            case(ButtonPress):
-              if (event.xbutton.button == Button1)
+    XDestroyImage(*julia_image);
+    XFreeGC(display, *julia_gc);
+    XDestroyWindow(display, *julia_window);
+    closeFractalWindow(display, &fractal_window);
+
+    return;
+  }
+
+/* 
+  Function openFractalWindow
+    -> Bind a mapped window to its view and frame, and start its history,
+       speculative render cache and smooth zoom state
+*/
+void openFractalWindow
+ (FractalWindow *fractal_window, Window *window, GC *gc, XImage **image,
+  unsigned long fractal_points[][HEIGHT][POINT_DEPTH], FractalView *view)
+  {
+    fractal_window->window = window;
+    fractal_window->gc = gc;
+    fractal_window->image = image;
+    fractal_window->fractal_points = fractal_points;
+    fractal_window->view = view;
+
+    /* Start the history with the initial view ... */
+
+    createHistory(&fractal_window->history);
+    pushHistory(&fractal_window->history, view, fractal_points);
+
+    /* Plan speculative renders around the initial view ... */
+
+    fractal_window->pointer_x = -1;
+    fractal_window->pointer_y = -1;
+    createPrefetch(&fractal_window->prefetch);
+    planPrefetch(&fractal_window->prefetch, view, -1, -1);
+    createZoom(&fractal_window->zoom);
+
+    return;
+  }
+
+/* 
+  Function closeFractalWindow
+    -> Free the caches, image, graphics context and destroy window
+*/
+void closeFractalWindow(Display *display, FractalWindow *fractal_window)
+  {
+    freeZoom(&fractal_window->zoom);
+    freePrefetch(&fractal_window->prefetch);
+    freeHistory(&fractal_window->history);
+    XDestroyImage(*fractal_window->image);
+    XFreeGC(display, *fractal_window->gc);
+    XDestroyWindow(display, *fractal_window->window);
+
+    return;
+  }
+
+/* 
+  Function idleFractalWindow
+    -> Do one short step of background work for a window ...
+      -> sharpen a smoothly zoomed frame first, keeping it in the history
+         once converged, then render likely next views
+      -> returns 0 if there was nothing left to do
+*/
+int idleFractalWindow(Display *display, FractalWindow *fractal_window)
+  {
+    if (fractal_window->zoom.pending > 0)
+      {
+        refineFrame(&fractal_window->zoom, fractal_window->view,
+                    fractal_window->fractal_points, (1.0 / ZOOM_FPS));
+        drawFractal(display, fractal_window->window, fractal_window->gc,
+                    *fractal_window->image, fractal_window->fractal_points);
+
+        if (fractal_window->zoom.pending == 0)
+          {
+            keepView(fractal_window);
+          }
+        return (1);
+      }
+
+    return (stepPrefetch(&fractal_window->prefetch));
+  }
+
+/* 
+  Function keepView
+    -> Record a window's newly converged view in the history and plan
+       speculative renders around it
+*/
+void keepView(FractalWindow *fractal_window)
+  {
+    pushHistory(&fractal_window->history, fractal_window->view, fractal_window->fractal_points);
+    planPrefetch(&fractal_window->prefetch, fractal_window->view,
+                 fractal_window->pointer_x, fractal_window->pointer_y);
+
+    return;
+  }
+
+/* 
+  Function settleZoom
+    -> Finish sharpening a smoothly zoomed frame now, without a time
+       limit, and record it ...
+      -> lets undo/redo step from the view on screen, not the one before
+*/
+void settleZoom(Display *display, FractalWindow *fractal_window)
+  {
+    if (fractal_window->zoom.pending > 0)
+      {
+        refineFrame(&fractal_window->zoom, fractal_window->view,
+                    fractal_window->fractal_points, HUGE_VAL);
+        drawFractal(display, fractal_window->window, fractal_window->gc,
+                    *fractal_window->image, fractal_window->fractal_points);
+        keepView(fractal_window);
+      }
+
+    return;
+  }
+
+/* 
+  Function handleWindowEvent
+    -> Process one event for a fractal window ...
+      -> left-click/drag selects a region, wheel and '+'/'-' zoom smoothly,
+         arrows pan, 'u'/'r' undo/redo, 'o' zooms out
+      -> returns 0 on 'q', mouse right-click or winmanager close
+*/
+int handleWindowEvent
+ (Display *display, int screen, FractalWindow *fractal_window, XEvent *event, Atom wmDeleteWindow)
+  {
+    FractalView   *view;
+    unsigned long (*fractal_points)[HEIGHT][POINT_DEPTH];
+
+    /* <key>, structure to hold keyboard input info */
+
+    KeySym key;
+
+    /* <keyPress>, char array to store entered keystrokes ... */
+
+    char keyPress[255];
+
+    int changed;
+
+    view = fractal_window->view;
+    fractal_points = fractal_window->fractal_points;
+
+    if (checkQuitEvent(event, wmDeleteWindow) == 1)
+      {
+        return (0);
+      }
+
+    /* <changed>, set once the view has moved and been rendered */
+
+    changed = 0;
+
+    switch(event->type)
+      {
+        case(Expose):
+          /* redraw contents of window ... */
+          drawFractal(display, fractal_window->window, fractal_window->gc,
+                      *fractal_window->image, fractal_points);
+        break;
+
+        case(MotionNotify):
+          /* only the latest pointer position matters ... */
+          while (XCheckTypedWindowEvent(display, *fractal_window->window, MotionNotify, event));
+
+          fractal_window->pointer_x = event->xmotion.x;
+          fractal_window->pointer_y = event->xmotion.y;
+          planPrefetch(&fractal_window->prefetch, view,
+                       fractal_window->pointer_x, fractal_window->pointer_y);
+        break;
+
+        case(ButtonPress):
+          /* real input, so drop any half-done speculative frame */
+          dropPrefetch(&fractal_window->prefetch);
+
+          if ((event->xbutton.button == Button4) || (event->xbutton.button == Button5))
+            {
+              /* mouse wheel, zoom smoothly about the pointer */
+              if (stepZoom(display, fractal_window->window, fractal_window->gc, *fractal_window->image,
+                           fractal_points, view, &fractal_window->zoom,
+                           event->xbutton.x, event->xbutton.y,
+                           (event->xbutton.button == Button4) ? ZOOM_STEP : (1 / ZOOM_STEP)) == 0)
                 {
-                  /* store first left-button click coordinates */
-                  px1 = event.xbutton.x;
-                  py1 = event.xbutton.y;
+                  /* sharp within the first frame already */
+                  keepView(fractal_window);
                 }
-              else if (event.xbutton.button == Button3)
+            }
+          else
+            {
+              trackHotSpot(display, screen, fractal_window->window, fractal_window->gc, event,
+                           &fractal_window->px1, &fractal_window->py1,
+                           &fractal_window->px2, &fractal_window->py2);
+            }
+        break;
+
+        case(ButtonRelease):
+          if (trackHotSpot(display, screen, fractal_window->window, fractal_window->gc, event,
+                           &fractal_window->px1, &fractal_window->py1,
+                           &fractal_window->px2, &fractal_window->py2) == 1)
+            {
+              /* create new data and redraw */
+              getNewBounds(view, fractal_window->px1, fractal_window->py1,
+                           fractal_window->px2, fractal_window->py2);
+              changed = 1;
+            }
+        break;
+
+        case(KeyPress):
+          dropPrefetch(&fractal_window->prefetch);
+
+          /* 
+            convert keypress data into a usable string
+              -> store string in <keyPress> array ...
+                   -> weird but necessary ...
+          */
+
+          XLookupString(&event->xkey, keyPress, 255, &key, 0);
+
+          if ((keyPress[0] == 'u') || (keyPress[0] == 'r'))
+            {
+              /* a zoomed view still sharpening is kept before stepping away */
+              settleZoom(display, fractal_window);
+            }
+
+          if (keyPress[0] == 'u')
+            {
+              /* step back, redrawing the cached frame */
+              if (undoHistory(&fractal_window->history, view, fractal_points))
                 {
-                  /* terminate if mouse right-click */
-                  continueLoop = 0;
+                  clearZoom(&fractal_window->zoom);
+                  drawFractal(display, fractal_window->window, fractal_window->gc,
+                              *fractal_window->image, fractal_points);
+                  planPrefetch(&fractal_window->prefetch, view,
+                               fractal_window->pointer_x, fractal_window->pointer_y);
                 }
-            break;
-
-            case(ButtonRelease):
-              if (event.xbutton.button == Button1)
+            }
+          else if (keyPress[0] == 'r')
+            {
+              /* step forward, redrawing the cached frame */
+              if (redoHistory(&fractal_window->history, view, fractal_points))
+                {
+                  clearZoom(&fractal_window->zoom);
+                  drawFractal(display, fractal_window->window, fractal_window->gc,
+                              *fractal_window->image, fractal_points);
+                  planPrefetch(&fractal_window->prefetch, view,
+                               fractal_window->pointer_x, fractal_window->pointer_y);
+                }
+            }
+          else if (keyPress[0] == 'o')
+            {
+              /* zoom out about the center, create new data and redraw */
+              zoomOutBounds(view);
+              changed = 1;
+            }
+          else if ((keyPress[0] == '+') || (keyPress[0] == '=') || (keyPress[0] == '-'))
+            {
+              /* held key (auto-repeat), zoom smoothly about the center */
+              if (stepZoom(display, fractal_window->window, fractal_window->gc, *fractal_window->image,
+                           fractal_points, view, &fractal_window->zoom,
+                           (WIDTH / 2), (HEIGHT / 2),
+                           (keyPress[0] == '-') ? (1 / ZOOM_STEP) : ZOOM_STEP) == 0)
                 {
-                  /* store second left-button click coordinates */
-                  px2 = event.xbutton.x;
-                  py2 = event.xbutton.y;
+                  keepView(fractal_window);
+                }
+            }
+          else if ((key == XK_Left) || (key == XK_Right) ||
+                   (key == XK_Up) || (key == XK_Down))
+            {
+              /* pan by half a view, create new data and redraw */
+              panBounds(view, (key == XK_Right) - (key == XK_Left),
+                              (key == XK_Up) - (key == XK_Down));
+              changed = 1;
+            }
+        break;
+      }
 
-                  if ((px1 != px2) && (py1 != py2))
-                    {
-                      /* Draw hotspot triangle to mark user region selection */
-                      drawHotSpot(display, screen, window, gc, px1, py1, px2, py2);
-                    }
+    if (changed == 1)
+      {
+        renderView(view, fractal_points, &fractal_window->history, &fractal_window->prefetch);
+        clearZoom(&fractal_window->zoom);
+        drawFractal(display, fractal_window->window, fractal_window->gc,
+                    *fractal_window->image, fractal_points);
+        planPrefetch(&fractal_window->prefetch, view,
+                     fractal_window->pointer_x, fractal_window->pointer_y);
+      }
 
-                  /* create new data and redraw */
+    return (1);
+  }
 
-                  createFractal(fractal_type, fractal_color, fractal_points, px1, py1, px2, py2);
-                  drawFractal(display, window, gc, fractal_points);
-                }
-            break;
+/* 
+  Function checkQuitEvent
+    -> Return 1 for 'q', mouse right-click or winmanager close
+*/
+int checkQuitEvent(XEvent *event, Atom wmDeleteWindow)
+  {
+    KeySym key;
 
-            case(KeyPress):
-              /* 
-                convert keypress data into a usable string
-                  -> store string in <keyPress> array ...
-                       -> weird but necessary ...
-              */
+    char keyPress[255];
 
-              XLookupString(&event.xkey, keyPress, 255, &key, 0);
+    switch(event->type)
+      {
+        case(ButtonPress):
+          /* terminate if mouse right-click */
+          return (event->xbutton.button == Button3);
+
+        case(KeyPress):
+          /* terminate if 'q' key pressed */
+          XLookupString(&event->xkey, keyPress, 255, &key, 0);
+          return (keyPress[0] == 'q');
+
+        case(ClientMessage):
+          /* terminate if window manager says so! */
+          return (event->xclient.data.l[0] == wmDeleteWindow);
+      }
 
-              if (keyPress[0] == 'q')
-                {
-                  /* terminate if 'q' key pressed */
-                  continueLoop = 0;
-                }
-            break;
+    return (0);
+  }
 
-            case(ClientMessage):
-              if(event.xclient.data.l[0] == wmDeleteWindow)
-                {
-                  /* terminate if window manager says so! */
-                  continueLoop = 0;
-                }
-            break;
+/* 
+  Function trackHotSpot
+    -> Follow a left-click or left-click-and-drag region selection ...
+      -> stores the press (<px1>, <py1>) and release (<px2>, <py2>) points
+      -> marks a dragged region with a hotspot rectangle
+      -> returns 1 once the selection is complete (on release)
+*/
+int trackHotSpot
+ (Display *display, int screen, Window *window, GC *gc, XEvent *event,
+  int *px1, int *py1, int *px2, int *py2)
+  {
+    if ((event->type == ButtonPress) && (event->xbutton.button == Button1))
+      {
+        /* store first left-button click coordinates */
+        *px1 = event->xbutton.x;
+        *py1 = event->xbutton.y;
+      }
+    else if ((event->type == ButtonRelease) && (event->xbutton.button == Button1))
+      {
+        /* store second left-button click coordinates */
+        *px2 = event->xbutton.x;
+        *py2 = event->xbutton.y;
+
+        if ((*px1 != *px2) && (*py1 != *py2))
+          {
+            /* Draw hotspot triangle to mark user region selection */
+            drawHotSpot(display, screen, window, gc, *px1, *py1, *px2, *py2);
           }
+
+        return (1);
       }
 
-    /* Free the associated graphics context and destroy window */
+    return (0);
+  }
 
-    XFreeGC(display, *gc);
-    XDestroyWindow(display, *window);
+/* 
+  Function renderView
+    -> Produce the frame for a view that has just changed ...
+      -> reuse a speculative frame if one was prefetched, else render
+      -> record the result in the history
+*/
+void renderView
+ (FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], 
+  FractalHistory *history, FractalPrefetch *prefetch)
+  {
+    if (fetchPrefetch(prefetch, view, fractal_points) == 0)
+      {
+        renderFractal(view, fractal_points);
+      }
+
+    pushHistory(history, view, fractal_points);
 
     return;
   }
 
+/* 
+  Function stepZoom
+    -> Show one frame of a smooth zoom by <factor> about pixel (<px>, <py>) ...
+      -> reproject the current frame, then refine the blurriest tiles
+         within one frame budget; the rest is refined while idle
+      -> returns the number of tiles still blurry (0 if converged)
+*/
+int stepZoom
+ (Display *display, Window *window, GC *gc, XImage *image, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], 
+  FractalView *view, FractalZoom *zoom, int px, int py, double factor)
+  {
+    FractalView old;
+
+    old = *view;
+    zoomBounds(view, px, py, factor);
+
+    reprojectFrame(zoom, &old, view, fractal_points);
+    refineFrame(zoom, view, fractal_points, (1.0 / ZOOM_FPS));
+    drawFractal(display, window, gc, image, fractal_points);
+
+    return (zoom->pending);
+  }
+
 /* 
   Function createGC
     -> Create and bind a graphics context with a window
@@ -277,6 +765,45 @@ void createGC
     return;
   }
 
+/* 
+  Function createImage
+    -> Create the client-side image a window's frames are drawn through ...
+      -> one per window, released with XDestroyImage along with it
+*/
+void createImage
+ (Display *display, int screen, XImage **image)
+  {
+    *image = XCreateImage
+             (
+               display,
+               DefaultVisual(display, screen),
+               DefaultDepth(display, screen),
+               ZPixmap,
+               0,
+               NULL,
+               WIDTH,
+               HEIGHT,
+               32,
+               0
+             );
+    if (*image == NULL)
+      {
+        /* Can't draw any frames, so notify and quit ... */
+
+        printf("Could not create window image.\n");
+        exit(1);
+      }
+
+    (*image)->data = malloc((*image)->bytes_per_line * HEIGHT);
+    if ((*image)->data == NULL)
+      {
+        printf("Could not allocate window image.\n");
+        exit(1);
+      }
+
+    return;
+  }
+
 /* 
   Function drawHotSpot
     -> Draw a rectangle hotspot highlighting user region selection
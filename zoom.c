@@ -0,0 +1,254 @@
+/*
+ * zoom.c: X-Fractals / smooth zoom by frame reprojection and budgeted tile refinement
+ *
+ * Authored by Parmjit Virk (2017)
+ *
+ * Licensed under the MIT license as per the Open Source Initiative 2017.
+ * See the LICENSE file for the complete license information,
+ * or visit https://opensource.org/licenses/MIT for details.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <X11/Xlib.h>
+#include "Xfractals.h"
+
+/* Define local function prototypes ... */
+double getSeconds(void);
+
+/*
+  Function createZoom
+    -> Allocate the scratch frame, with every tile exact
+*/
+void createZoom(FractalZoom *zoom)
+  {
+    zoom->scratch = malloc(sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+    if (zoom->scratch == NULL)
+      {
+        /* Can't reproject frames, so notify and quit ... */
+
+        printf("Could not allocate zoom frame.\n");
+        exit(1);
+      }
+
+    clearZoom(zoom);
+
+    return;
+  }
+
+/*
+  Function freeZoom
+    -> Release the scratch frame
+*/
+void freeZoom(FractalZoom *zoom)
+  {
+    free(zoom->scratch);
+    zoom->scratch = NULL;
+
+    return;
+  }
+
+/*
+  Function clearZoom
+    -> Mark every tile exact, e.g. after a full render replaced the frame
+*/
+void clearZoom(FractalZoom *zoom)
+  {
+    int tx, ty;
+
+    for (tx = 0 ; tx < TILES_X ; tx++)
+      {
+        for (ty = 0 ; ty < TILES_Y ; ty++)
+          {
+            zoom->blur[tx][ty] = 0;
+          }
+      }
+
+    zoom->pending = 0;
+
+    return;
+  }
+
+/*
+  Function reprojectFrame
+    -> Resample the frame of view <old> into view <new> ...
+      -> nearest neighbour scaling of the previous pixels
+      -> points outside the previous frame are left black
+      -> each tile inherits the blur of its source plus the zoom step, so
+         repeatedly scaled tiles are refined first
+*/
+void reprojectFrame
+ (FractalZoom *zoom, FractalView *old, FractalView *new, unsigned long fractal_points[][HEIGHT][POINT_DEPTH])
+  {
+    double old_blur[TILES_X][TILES_Y];
+
+    double old_x_inc,
+           old_y_inc,
+           new_x_inc,
+           new_y_inc,
+           x_offset,
+           y_offset,
+           step;
+
+    int px, py, sx, sy, tx, ty, missing;
+
+    memcpy(zoom->scratch, fractal_points, sizeof(unsigned long [WIDTH][HEIGHT][POINT_DEPTH]));
+    memcpy(old_blur, zoom->blur, sizeof(old_blur));
+
+    old_x_inc = (getSpan(old->xmax, old->xmax_lo, old->xmin, old->xmin_lo) / WIDTH);
+    old_y_inc = (getSpan(old->ymax, old->ymax_lo, old->ymin, old->ymin_lo) / HEIGHT);
+    new_x_inc = (getSpan(new->xmax, new->xmax_lo, new->xmin, new->xmin_lo) / WIDTH);
+    new_y_inc = (getSpan(new->ymax, new->ymax_lo, new->ymin, new->ymin_lo) / HEIGHT);
+    step = fabs(log(new_x_inc / old_x_inc));
+
+    /* Offset of the new top-left corner from the old one, exact at any depth */
+
+    x_offset = getSpan(new->xmin, new->xmin_lo, old->xmin, old->xmin_lo);
+    y_offset = getSpan(old->ymax, old->ymax_lo, new->ymax, new->ymax_lo);
+
+    /* Scale the previous pixels into place ... */
+
+    for (px = 0 ; px < WIDTH ; px++)
+      {
+        sx = (int)floor(((x_offset + (px * new_x_inc)) / old_x_inc) + 0.5);
+
+        for (py = 0 ; py < HEIGHT ; py++)
+          {
+            sy = (int)floor(((y_offset + (py * new_y_inc)) / old_y_inc) + 0.5);
+
+            /* Every channel of the pixel moves, not just its color */
+
+            if ((sx >= 0) && (sx < WIDTH) && (sy >= 0) && (sy < HEIGHT))
+              {
+                memcpy(fractal_points[px][py], zoom->scratch[sx][sy], sizeof(fractal_points[px][py]));
+              }
+            else
+              {
+                memset(fractal_points[px][py], 0, sizeof(fractal_points[px][py]));
+              }
+          }
+      }
+
+    /* Work out how blurry each tile now is ... */
+
+    zoom->pending = 0;
+
+    for (tx = 0 ; tx < TILES_X ; tx++)
+      {
+        for (ty = 0 ; ty < TILES_Y ; ty++)
+          {
+            /* A tile with any corner outside the previous frame is missing data */
+
+            missing = 0;
+            for (px = (tx * TILE_SIZE) ; px <= ((tx + 1) * TILE_SIZE) ; px += TILE_SIZE)
+              {
+                for (py = (ty * TILE_SIZE) ; py <= ((ty + 1) * TILE_SIZE) ; py += TILE_SIZE)
+                  {
+                    sx = (int)floor((x_offset + (px * new_x_inc)) / old_x_inc);
+                    sy = (int)floor((y_offset + (py * new_y_inc)) / old_y_inc);
+
+                    if ((sx < 0) || (sx > WIDTH) || (sy < 0) || (sy > HEIGHT))
+                      {
+                        missing = 1;
+                      }
+                  }
+              }
+
+            if (missing == 1)
+              {
+                zoom->blur[tx][ty] = ZOOM_BLUR_MISSING;
+              }
+            else
+              {
+                /* Source tile is the one under this tile's center */
+
+                sx = (int)floor(((x_offset + (((tx * TILE_SIZE) + (TILE_SIZE / 2)) * new_x_inc)) / old_x_inc) / TILE_SIZE);
+                sy = (int)floor(((y_offset + (((ty * TILE_SIZE) + (TILE_SIZE / 2)) * new_y_inc)) / old_y_inc) / TILE_SIZE);
+                sx = (sx >= TILES_X) ? (TILES_X - 1) : sx;
+                sy = (sy >= TILES_Y) ? (TILES_Y - 1) : sy;
+
+                zoom->blur[tx][ty] = (old_blur[sx][sy] + step);
+              }
+
+            if (zoom->blur[tx][ty] > 0)
+              {
+                zoom->pending++;
+              }
+          }
+      }
+
+    return;
+  }
+
+/*
+  Function refineFrame
+    -> Re-render the blurriest tiles until <budget> seconds are used ...
+      -> at least one tile is rendered per call
+      -> returns the number of tiles still blurry
+*/
+int refineFrame
+ (FractalZoom *zoom, FractalView *view, unsigned long fractal_points[][HEIGHT][POINT_DEPTH], double budget)
+  {
+    double start;
+
+    int tx, ty, best_x, best_y, px_end, py_end;
+
+    start = getSeconds();
+
+    while (zoom->pending > 0)
+      {
+        /* Find the blurriest tile ... */
+
+        best_x = 0;
+        best_y = 0;
+        for (tx = 0 ; tx < TILES_X ; tx++)
+          {
+            for (ty = 0 ; ty < TILES_Y ; ty++)
+              {
+                if (zoom->blur[tx][ty] > zoom->blur[best_x][best_y])
+                  {
+                    best_x = tx;
+                    best_y = ty;
+                  }
+              }
+          }
+
+        px_end = ((best_x + 1) * TILE_SIZE);
+        py_end = ((best_y + 1) * TILE_SIZE);
+        px_end = (px_end > WIDTH) ? WIDTH : px_end;
+        py_end = (py_end > HEIGHT) ? HEIGHT : py_end;
+
+        renderFractalTile(view, fractal_points, (best_x * TILE_SIZE), px_end, (best_y * TILE_SIZE), py_end);
+
+        zoom->blur[best_x][best_y] = 0;
+        zoom->pending--;
+
+        if ((getSeconds() - start) >= budget)
+          {
+            break;
+          }
+      }
+
+    /* Equalized colors depend on the whole frame, old tiles included */
+
+    equalizeFractal(view, fractal_points, 0, WIDTH, 0, HEIGHT);
+
+    return (zoom->pending);
+  }
+
+/*
+  Function getSeconds
+    -> Return a monotonic time stamp in seconds
+*/
+double getSeconds(void)
+  {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec + (now.tv_nsec / 1e9));
+  }